@@ -34,11 +34,8 @@ extern const size_t __stop_custom_data __asm("section$end$__DATA$custom_data");
 #endif
 #endif
 
-#ifdef DEBUG_VERSION
+// not static: the interpreter bump-allocates objects from the heap inline
 memory_chunk heap;
-#else
-static memory_chunk heap;
-#endif
 
 #ifdef DEBUG_VERSION
 void dump_heap ();
@@ -62,6 +62,9 @@ typedef struct {
   size_t  size;
 } memory_chunk;
 
+// objects are allocated at `current` up to `end`, then the garbage is collected
+extern memory_chunk heap;
+
 // the only GC-related function that should be exposed, others are useful for tests and internal implementation
 // allocates object of the given size on the heap
 void *alloc(size_t);
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""
+Assembles a bytecode listing (.lasm) into a Lama bytecode file (.bc).
+
+A listing has an instruction per line, operands are integers or labels.
+`label:` defines a label, `globals N` sets the size of the global area,
+`public name label` adds a public symbol (the entry point is `main`), `#` starts a comment.
+CLOSURE is not supported.
+"""
+
+import struct
+import sys
+
+OPCODES = {
+    'BINOP_ADD': (0x01, 0), 'BINOP_SUB': (0x02, 0), 'BINOP_MUL': (0x03, 0), 'BINOP_DIV': (0x04, 0),
+    'BINOP_MOD': (0x05, 0), 'BINOP_LT': (0x06, 0), 'BINOP_LE': (0x07, 0), 'BINOP_GT': (0x08, 0),
+    'BINOP_GE': (0x09, 0), 'BINOP_EQ': (0x0a, 0), 'BINOP_NE': (0x0b, 0), 'BINOP_AND': (0x0c, 0),
+    'BINOP_OR': (0x0d, 0),
+    'CONST': (0x10, 1), 'STRING': (0x11, 1), 'SEXP': (0x12, 2), 'STI': (0x13, 0), 'STA': (0x14, 0),
+    'JMP': (0x15, 1), 'END': (0x16, 0), 'RET': (0x17, 0), 'DROP': (0x18, 0), 'DUP': (0x19, 0),
+    'SWAP': (0x1a, 0), 'ELEM': (0x1b, 0),
+    'LD_G': (0x20, 1), 'LD_L': (0x21, 1), 'LD_A': (0x22, 1), 'LD_C': (0x23, 1),
+    'LDA_G': (0x30, 1), 'LDA_L': (0x31, 1), 'LDA_A': (0x32, 1), 'LDA_C': (0x33, 1),
+    'ST_G': (0x40, 1), 'ST_L': (0x41, 1), 'ST_A': (0x42, 1), 'ST_C': (0x43, 1),
+    'CJMPZ': (0x50, 1), 'CJMPNZ': (0x51, 1), 'BEGIN': (0x52, 2), 'CBEGIN': (0x53, 2),
+    'CALLC': (0x55, 1), 'CALL': (0x56, 2), 'TAG': (0x57, 2), 'ARRAY': (0x58, 1), 'FAIL': (0x59, 2),
+    'LINE': (0x5a, 1),
+    'PATT_STR': (0x60, 0), 'PATT_STRING': (0x61, 0), 'PATT_ARRAY': (0x62, 0), 'PATT_SEXP': (0x63, 0),
+    'PATT_REF': (0x64, 0), 'PATT_VAL': (0x65, 0), 'PATT_FUN': (0x66, 0),
+    'CALL_LREAD': (0x70, 0), 'CALL_LWRITE': (0x71, 0), 'CALL_LLENGTH': (0x72, 0),
+    'CALL_LSTRING': (0x73, 0), 'CALL_BARRAY': (0x74, 1),
+}
+
+CODE_END_MARKER = b'\xff'
+
+
+def parse(path):
+    globals_size = 0
+    publics = []
+    instructions = []
+    labels = {}
+    offset = 0
+
+    with open(path) as f:
+        for line in f:
+            words = line.split('#', 1)[0].split()
+
+            if not words:
+                continue
+
+            if words[0] == 'globals':
+                globals_size = int(words[1])
+            elif words[0] == 'public':
+                publics.append((words[1], words[2]))
+            elif words[0].endswith(':'):
+                labels[words[0][:-1]] = offset
+            else:
+                opcode, operands_number = OPCODES[words[0]]
+
+                if len(words) - 1 != operands_number:
+                    sys.exit(f'{path}: {words[0]} takes {operands_number} operands')
+
+                instructions.append((opcode, words[1:]))
+                offset += 1 + 4 * operands_number
+
+    return globals_size, publics, instructions, labels
+
+
+def assemble(path):
+    globals_size, publics, instructions, labels = parse(path)
+
+    def resolve(operand):
+        return labels[operand] if operand in labels else int(operand)
+
+    code = b''
+
+    for opcode, operands in instructions:
+        code += bytes([opcode]) + b''.join(struct.pack('<i', resolve(operand)) for operand in operands)
+
+    string_table = b''
+    public_table = b''
+
+    for name, label in publics:
+        public_table += struct.pack('<ii', len(string_table), labels[label])
+        string_table += name.encode() + b'\0'
+
+    header = struct.pack('<iii', len(string_table), globals_size, len(publics))
+
+    return header + public_table + string_table + code + CODE_END_MARKER
+
+
+if __name__ == '__main__':
+    for path in sys.argv[1:]:
+        with open(path[:-len('.lasm')] + '.bc', 'wb') as f:
+            f.write(assemble(path))
@@ -0,0 +1,4 @@
+  $ ../src/Driver.exe -runtime ../runtime -I ../stdlib/x64 -i test804.lama < test804.input
+  5000050000
+  1
+  0
@@ -0,0 +1,4 @@
+  $ ../src/Driver.exe -runtime ../runtime -I ../stdlib/x64 -i test805.lama < test805.input
+  100000
+  33334
+  50000
@@ -0,0 +1,69 @@
+#!/usr/bin/env bash
+
+cd $(dirname $0)
+
+EXECUTABLE_NAME=lama-util
+ITER_INTERPRETER="$PWD/$EXECUTABLE_NAME"
+
+LAMA_HOME=$PWD/deps/Lama
+BYTECODE_TEST_DIR=$LAMA_HOME/tests/bytecode
+
+# every test is run with each of the option sets, PROFILE stands for the idiom profile of the test itself
+MODE_OPTIONS=("" "-s" "-l" "-j" "-s -c" "-p PROFILE" "-s -p PROFILE")
+
+function run_single_bytecode_test() {
+    testfile=$1
+    options=$2
+
+    bytecode_file=${testfile/.lasm/.bc}
+    expected_output=${testfile/.lasm/.out}
+    interpreter_output=${testfile/.lasm/.out1}
+    idiom_profile=${testfile/.lasm/.prof}
+
+    python3 assemble.py $testfile
+
+    if [ $? -ne 0 ]; then
+        echo -1
+        return
+    fi
+
+    $ITER_INTERPRETER -i -p $idiom_profile $bytecode_file >/dev/null 2>&1
+
+    $ITER_INTERPRETER ${options/PROFILE/$idiom_profile} $bytecode_file </dev/null >$interpreter_output 2>&1
+
+    cmp $interpreter_output $expected_output 1>/dev/null 2>/dev/null
+
+    echo $?
+}
+
+function run_bytecode_tests() {
+    cd $BYTECODE_TEST_DIR
+
+    for testfile in $BYTECODE_TEST_DIR/*.lasm; do
+        for options in "${MODE_OPTIONS[@]}"; do
+            test_simple_name="$(basename $testfile) [$options]"
+            test_result=$(run_single_bytecode_test $testfile "$options")
+
+            test_status="passed"
+
+            if [ "$test_result" -lt 0 ]; then
+                test_status="assembling failed"
+            elif [ "$test_result" -gt 0 ]; then
+                test_status="failed"
+            fi
+
+            echo -e "$test_simple_name: $test_status"
+
+            if [ "$test_result" -gt 0 ]; then
+                echo "expected output:"
+                cat ${testfile/.lasm/.out}
+                echo -e "\nactual output:"
+                cat ${testfile/.lasm/.out1}
+            fi
+
+            echo
+        done
+    done
+}
+
+run_bytecode_tests
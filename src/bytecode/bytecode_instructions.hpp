@@ -1,6 +1,11 @@
 #ifndef BYTECODE_BYTECODE_INSTRUCTIONS_HPP
 #define BYTECODE_BYTECODE_INSTRUCTIONS_HPP
 
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
 namespace lama::bytecode {
 enum class InstructionOpCode : unsigned char {
     BINOP_ADD = 0x01,
@@ -79,7 +84,234 @@ enum class InstructionOpCode : unsigned char {
     CALL_LLENGTH = 0x72,
     CALL_LSTRING = 0x73,
     CALL_BARRAY = 0x74,
+
+    /*
+     * Internal opcodes are never produced by the Lama compiler, the interpreter rewrites
+     * decoded instructions with them. They are spelled in lama::interpreter without the prefix
+     */
+    QUICK_BINOP_ADD = 0xc1,
+    QUICK_BINOP_SUB = 0xc2,
+    QUICK_BINOP_MUL = 0xc3,
+    QUICK_BINOP_DIV = 0xc4,
+    QUICK_BINOP_MOD = 0xc5,
+    QUICK_BINOP_LT = 0xc6,
+    QUICK_BINOP_LE = 0xc7,
+    QUICK_BINOP_GT = 0xc8,
+    QUICK_BINOP_GE = 0xc9,
+    QUICK_BINOP_EQ = 0xca,
+    QUICK_BINOP_NE = 0xcb,
+    QUICK_BINOP_AND = 0xcc,
+    QUICK_BINOP_OR = 0xcd,
+
+    QUICK_CJMPZ = 0xd0,
+    QUICK_CJMPNZ = 0xd1,
+
+    SUPER_LD_L_CONST = 0xe0,
+    SUPER_LD_A_CONST = 0xe1,
+    SUPER_CONST_ADD = 0xe2,
+    SUPER_CONST_SUB = 0xe3,
+    SUPER_LD_L_CJMPZ = 0xe4,
+    SUPER_LD_A_CJMPZ = 0xe5,
+    SUPER_DUP_TAG = 0xe6,
+    SUPER_ST_L_DROP = 0xe7,
+
+    PSEUDO_INVALID_JUMP = 0xf0,
+    PSEUDO_END_OF_CODE = 0xf1,
+    PSEUDO_TAIL_CALL = 0xf2,
+    PSEUDO_TAIL_CALLC = 0xf3,
+    PSEUDO_UNVERIFIED_BEGIN = 0xf4,
+    PSEUDO_UNVERIFIED_CBEGIN = 0xf5,
+};
+
+/* Terminates the code section produced by the Lama compiler, it is not an instruction */
+constexpr unsigned char CODE_END_MARKER = 0xff;
+
+/*
+ * Words popped and pushed by an instruction. The value of the immediate operand popsOperand (if any)
+ * is added to pops. The effect of STA is not exact: it pops 2 words instead of 3 if its destination is a reference
+ */
+struct InstructionStackEffect {
+    static constexpr std::int8_t NO_OPERAND = -1;
+
+    std::uint8_t pops = 0;
+    std::uint8_t pushes = 0;
+    std::int8_t popsOperand = NO_OPERAND;
+    bool exact = true;
+};
+
+/*
+ * Static properties of an instruction. Every instruction is an opcode byte followed by operandsNumber
+ * 32-bit immediates, CLOSURE is additionally followed by its captures (a byte and a 32-bit index each)
+ */
+struct InstructionInfo {
+    /* The name as it is spelled in InstructionOpCode, empty for unknown opcodes */
+    std::string_view name;
+    std::uint8_t operandsNumber = 0;
+    bool hasCaptures = false;
+
+    /* The first operand is a code offset: a jump target, a callee or a closure body */
+    bool hasCodeOffset = false;
+
+    /* Control may be transferred to the code offset of the instruction (JMP, CJMPZ, CJMPNZ, CALL) */
+    bool isBranch = false;
+    bool isCall = false;
+
+    /* Execution never falls through to the next instruction */
+    bool isTerminal = false;
+
+    InstructionStackEffect stackEffect;
 };
+
+namespace detail {
+    constexpr std::array<InstructionInfo, 256> makeInstructionTable() {
+        std::array<InstructionInfo, 256> table{};
+
+        const auto set = [&table](InstructionOpCode opcode, const InstructionInfo &info) {
+            table[static_cast<unsigned char>(opcode)] = info;
+        };
+
+        set(InstructionOpCode::BINOP_ADD, {.name = "BINOP_ADD", .stackEffect = {2, 1}});
+        set(InstructionOpCode::BINOP_SUB, {.name = "BINOP_SUB", .stackEffect = {2, 1}});
+        set(InstructionOpCode::BINOP_MUL, {.name = "BINOP_MUL", .stackEffect = {2, 1}});
+        set(InstructionOpCode::BINOP_DIV, {.name = "BINOP_DIV", .stackEffect = {2, 1}});
+        set(InstructionOpCode::BINOP_MOD, {.name = "BINOP_MOD", .stackEffect = {2, 1}});
+        set(InstructionOpCode::BINOP_LT, {.name = "BINOP_LT", .stackEffect = {2, 1}});
+        set(InstructionOpCode::BINOP_LE, {.name = "BINOP_LE", .stackEffect = {2, 1}});
+        set(InstructionOpCode::BINOP_GT, {.name = "BINOP_GT", .stackEffect = {2, 1}});
+        set(InstructionOpCode::BINOP_GE, {.name = "BINOP_GE", .stackEffect = {2, 1}});
+        set(InstructionOpCode::BINOP_EQ, {.name = "BINOP_EQ", .stackEffect = {2, 1}});
+        set(InstructionOpCode::BINOP_NE, {.name = "BINOP_NE", .stackEffect = {2, 1}});
+        set(InstructionOpCode::BINOP_AND, {.name = "BINOP_AND", .stackEffect = {2, 1}});
+        set(InstructionOpCode::BINOP_OR, {.name = "BINOP_OR", .stackEffect = {2, 1}});
+
+        set(InstructionOpCode::CONST, {.name = "CONST", .operandsNumber = 1, .stackEffect = {0, 1}});
+        set(InstructionOpCode::STRING, {.name = "STRING", .operandsNumber = 1, .stackEffect = {0, 1}});
+        set(InstructionOpCode::SEXP, {.name = "SEXP", .operandsNumber = 2, .stackEffect = {0, 1, 1}});
+        set(InstructionOpCode::STI, {.name = "STI", .stackEffect = {2, 1}});
+        set(InstructionOpCode::STA, {.name = "STA", .stackEffect = {3, 1, InstructionStackEffect::NO_OPERAND, false}});
+
+        set(InstructionOpCode::JMP, {
+            .name = "JMP",
+            .operandsNumber = 1,
+            .hasCodeOffset = true,
+            .isBranch = true,
+            .isTerminal = true,
+            .stackEffect = {},
+        });
+        set(InstructionOpCode::END, {.name = "END", .isTerminal = true, .stackEffect = {1, 0}});
+        set(InstructionOpCode::RET, {.name = "RET", .isTerminal = true, .stackEffect = {1, 0}});
+
+        set(InstructionOpCode::DROP, {.name = "DROP", .stackEffect = {1, 0}});
+        set(InstructionOpCode::DUP, {.name = "DUP", .stackEffect = {1, 2}});
+        set(InstructionOpCode::SWAP, {.name = "SWAP", .stackEffect = {2, 2}});
+        set(InstructionOpCode::ELEM, {.name = "ELEM", .stackEffect = {2, 1}});
+
+        set(InstructionOpCode::LD_G, {.name = "LD_G", .operandsNumber = 1, .stackEffect = {0, 1}});
+        set(InstructionOpCode::LD_L, {.name = "LD_L", .operandsNumber = 1, .stackEffect = {0, 1}});
+        set(InstructionOpCode::LD_A, {.name = "LD_A", .operandsNumber = 1, .stackEffect = {0, 1}});
+        set(InstructionOpCode::LD_C, {.name = "LD_C", .operandsNumber = 1, .stackEffect = {0, 1}});
+
+        set(InstructionOpCode::LDA_G, {.name = "LDA_G", .operandsNumber = 1, .stackEffect = {0, 1}});
+        set(InstructionOpCode::LDA_L, {.name = "LDA_L", .operandsNumber = 1, .stackEffect = {0, 1}});
+        set(InstructionOpCode::LDA_A, {.name = "LDA_A", .operandsNumber = 1, .stackEffect = {0, 1}});
+        set(InstructionOpCode::LDA_C, {.name = "LDA_C", .operandsNumber = 1, .stackEffect = {0, 1}});
+
+        // the stored value stays on the stack
+        set(InstructionOpCode::ST_G, {.name = "ST_G", .operandsNumber = 1, .stackEffect = {1, 1}});
+        set(InstructionOpCode::ST_L, {.name = "ST_L", .operandsNumber = 1, .stackEffect = {1, 1}});
+        set(InstructionOpCode::ST_A, {.name = "ST_A", .operandsNumber = 1, .stackEffect = {1, 1}});
+        set(InstructionOpCode::ST_C, {.name = "ST_C", .operandsNumber = 1, .stackEffect = {1, 1}});
+
+        set(InstructionOpCode::CJMPZ, {
+            .name = "CJMPZ",
+            .operandsNumber = 1,
+            .hasCodeOffset = true,
+            .isBranch = true,
+            .stackEffect = {1, 0},
+        });
+        set(InstructionOpCode::CJMPNZ, {
+            .name = "CJMPNZ",
+            .operandsNumber = 1,
+            .hasCodeOffset = true,
+            .isBranch = true,
+            .stackEffect = {1, 0},
+        });
+
+        set(InstructionOpCode::BEGIN, {.name = "BEGIN", .operandsNumber = 2, .stackEffect = {}});
+        set(InstructionOpCode::CBEGIN, {.name = "CBEGIN", .operandsNumber = 2, .stackEffect = {}});
+
+        set(InstructionOpCode::CLOSURE, {
+            .name = "CLOSURE",
+            .operandsNumber = 2,
+            .hasCaptures = true,
+            .hasCodeOffset = true,
+            .stackEffect = {0, 1},
+        });
+
+        // the closure is popped along with the arguments
+        set(InstructionOpCode::CALLC, {.name = "CALLC", .operandsNumber = 1, .isCall = true, .stackEffect = {1, 1, 0}});
+        set(InstructionOpCode::CALL, {
+            .name = "CALL",
+            .operandsNumber = 2,
+            .hasCodeOffset = true,
+            .isBranch = true,
+            .isCall = true,
+            .stackEffect = {0, 1, 1},
+        });
+
+        set(InstructionOpCode::TAG, {.name = "TAG", .operandsNumber = 2, .stackEffect = {1, 1}});
+        set(InstructionOpCode::ARRAY, {.name = "ARRAY", .operandsNumber = 1, .stackEffect = {1, 1}});
+        set(InstructionOpCode::FAIL, {.name = "FAIL", .operandsNumber = 2, .isTerminal = true, .stackEffect = {1, 0}});
+        set(InstructionOpCode::LINE, {.name = "LINE", .operandsNumber = 1, .stackEffect = {}});
+
+        set(InstructionOpCode::PATT_STR, {.name = "PATT_STR", .stackEffect = {2, 1}});
+        set(InstructionOpCode::PATT_STRING, {.name = "PATT_STRING", .stackEffect = {1, 1}});
+        set(InstructionOpCode::PATT_ARRAY, {.name = "PATT_ARRAY", .stackEffect = {1, 1}});
+        set(InstructionOpCode::PATT_SEXP, {.name = "PATT_SEXP", .stackEffect = {1, 1}});
+        set(InstructionOpCode::PATT_REF, {.name = "PATT_REF", .stackEffect = {1, 1}});
+        set(InstructionOpCode::PATT_VAL, {.name = "PATT_VAL", .stackEffect = {1, 1}});
+        set(InstructionOpCode::PATT_FUN, {.name = "PATT_FUN", .stackEffect = {1, 1}});
+
+        set(InstructionOpCode::CALL_LREAD, {.name = "CALL_LREAD", .stackEffect = {0, 1}});
+        set(InstructionOpCode::CALL_LWRITE, {.name = "CALL_LWRITE", .stackEffect = {1, 1}});
+        set(InstructionOpCode::CALL_LLENGTH, {.name = "CALL_LLENGTH", .stackEffect = {1, 1}});
+        set(InstructionOpCode::CALL_LSTRING, {.name = "CALL_LSTRING", .stackEffect = {1, 1}});
+        set(InstructionOpCode::CALL_BARRAY, {.name = "CALL_BARRAY", .operandsNumber = 1, .stackEffect = {0, 1, 0}});
+
+        return table;
+    }
+}
+
+/*
+ * The single description of the instruction set, the decoders of the interpreter, the verifier
+ * and the idiom analyzer are checked against it
+ */
+inline constexpr std::array<InstructionInfo, 256> INSTRUCTIONS = detail::makeInstructionTable();
+
+constexpr const InstructionInfo& getInstructionInfo(InstructionOpCode opcode) {
+    return INSTRUCTIONS[static_cast<unsigned char>(opcode)];
+}
+
+constexpr bool isValidInstruction(InstructionOpCode opcode) {
+    return !getInstructionInfo(opcode).name.empty();
+}
+
+/* Returns the name of the opcode as it is spelled in InstructionOpCode, or an empty string for unknown opcodes */
+constexpr std::string_view getInstructionName(InstructionOpCode opcode) {
+    return getInstructionInfo(opcode).name;
+}
+
+constexpr std::optional<InstructionOpCode> findInstructionByName(std::string_view name) {
+    for (unsigned int i = 0; i <= 0xff; ++i) {
+        const InstructionOpCode opcode{static_cast<unsigned char>(i)};
+
+        if (!name.empty() && getInstructionName(opcode) == name) {
+            return opcode;
+        }
+    }
+
+    return std::nullopt;
+}
 }
 
 #endif
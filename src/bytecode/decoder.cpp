@@ -1,29 +1,123 @@
 #include "decoder.hpp"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 #include <optional>
 
 #include "bytecode_instructions.hpp"
 
+namespace {
+    constexpr std::size_t INT_SIZE = sizeof(std::int32_t);
+    constexpr std::size_t CAPTURE_SIZE = sizeof(std::byte) + INT_SIZE;
+
+    static_assert(std::all_of(
+        lama::bytecode::INSTRUCTIONS.begin(),
+        lama::bytecode::INSTRUCTIONS.end(),
+        [](const lama::bytecode::InstructionInfo &info) { return info.operandsNumber <= lama::bytecode::decoder::MAX_OPERANDS_NUMBER; }
+    ));
+
+    std::int32_t readOperand(const lama::bytecode::BytecodeFile *file, lama::bytecode::offset_t offset, std::size_t index) {
+        std::int32_t val;
+        file->copyCodeBytes(reinterpret_cast<std::byte *>(&val), offset + 1 + index * INT_SIZE, sizeof(val));
+
+        return val;
+    }
+}
+
+std::optional<std::uint32_t> lama::bytecode::decoder::getInstructionLength(const lama::bytecode::BytecodeFile *file, offset_t offset) {
+    const std::optional<Instruction> instr = decodeInstruction(file, offset);
+
+    // the end marker is not an instruction
+    if (!instr || instr->isEndMarker()) {
+        return std::nullopt;
+    }
+
+    return instr->length;
+}
+
+std::optional<lama::bytecode::decoder::Instruction> lama::bytecode::decoder::decodeInstruction(
+    const lama::bytecode::BytecodeFile *file,
+    offset_t offset
+) {
+    const std::size_t codeSize = file->getCodeSize();
+
+    if (offset >= codeSize) {
+        return std::nullopt;
+    }
+
+    const std::byte *code = &file->getCodeByte(offset);
+    const InstructionOpCode opcode{static_cast<unsigned char>(code[0])};
+
+    if (static_cast<unsigned char>(opcode) == CODE_END_MARKER) {
+        return Instruction{offset, opcode, 1, {}};
+    }
+
+    const InstructionInfo &info = getInstructionInfo(opcode);
+
+    if (info.name.empty()) {
+        return std::nullopt;
+    }
+
+    std::size_t length = 1 + info.operandsNumber * INT_SIZE;
+
+    if (length > codeSize - offset) {
+        return std::nullopt;
+    }
+
+    Instruction instr{offset, opcode, 0, {}};
+    std::memcpy(instr.operands.data(), code + 1, info.operandsNumber * INT_SIZE);
+
+    // the captures number is the last operand, a negative number means no captures
+    if (info.hasCaptures) {
+        const std::int32_t captures = instr.operands[info.operandsNumber - 1];
+
+        if (captures > 0) {
+            if ((codeSize - offset - length) / CAPTURE_SIZE < static_cast<std::size_t>(captures)) {
+                return std::nullopt;
+            }
+
+            length += captures * CAPTURE_SIZE;
+        }
+    }
+
+    instr.length = length;
+
+    return instr;
+}
+
 std::optional<std::int32_t> lama::bytecode::decoder::getJumpAddress(const lama::bytecode::BytecodeFile *file, offset_t offset) {
-    const lama::bytecode::InstructionOpCode op = file->getInstruction(offset);
+    if (!getInstructionInfo(file->getInstruction(offset)).hasCodeOffset) {
+        return std::nullopt;
+    }
+
+    return readOperand(file, offset, 0);
+}
+
+std::optional<lama::bytecode::decoder::StackEffect> lama::bytecode::decoder::getStackEffect(
+    const lama::bytecode::BytecodeFile *file,
+    offset_t offset
+) {
+    const InstructionInfo &info = getInstructionInfo(file->getInstruction(offset));
+    const InstructionStackEffect &effect = info.stackEffect;
+
+    if (info.name.empty() || !effect.exact) {
+        return std::nullopt;
+    }
+
+    StackEffect result{effect.pops, effect.pushes};
+
+    if (effect.popsOperand != InstructionStackEffect::NO_OPERAND) {
+        const std::int32_t words = readOperand(file, offset, effect.popsOperand);
 
-    std::int32_t val;
-    std::optional<std::int32_t> res = std::nullopt;
+        if (words < 0) {
+            return std::nullopt;
+        }
 
-    switch (op) {
-        case InstructionOpCode::JMP:
-        case InstructionOpCode::CJMPZ:
-        case InstructionOpCode::CJMPNZ:
-        case InstructionOpCode::CLOSURE:
-        case InstructionOpCode::CALL:
-            file->copyCodeBytes(reinterpret_cast<std::byte *>(&val), offset + sizeof(op), sizeof(val));
-            res = {val};
-            break;
-        default:
-            break;
+        result.pops += words;
     }
 
-    return res;
+    return result;
 }
@@ -1,12 +1,120 @@
 #ifndef BYTECODE_DECODER_HPP
 #define BYTECODE_DECODER_HPP
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <optional>
 
+#include "bytecode_instructions.hpp"
 #include "source_file.hpp"
 
+/*
+ * Queries of single instructions derived from the instruction table (see getInstructionInfo),
+ * they do not disassemble the code
+ */
 namespace lama::bytecode::decoder {
+inline constexpr std::size_t MAX_OPERANDS_NUMBER = 2;
+
+/*
+ * An instruction decoded in place. The end marker of the code section is decoded as a one byte instruction
+ * without successors, so that a linear sweep stops on it
+ */
+struct Instruction {
+    offset_t offset;
+    InstructionOpCode opcode;
+    std::uint32_t length;
+
+    /* Immediate operands, the captures of CLOSURE are not decoded */
+    std::array<std::int32_t, MAX_OPERANDS_NUMBER> operands;
+
+    const InstructionInfo& getInfo() const {
+        return getInstructionInfo(opcode);
+    }
+
+    bool isEndMarker() const {
+        return static_cast<unsigned char>(opcode) == CODE_END_MARKER;
+    }
+
+    offset_t getNextOffset() const {
+        return offset + length;
+    }
+
+    /* Returns std::nullopt if execution never falls through to the next instruction */
+    std::optional<offset_t> getFallThroughSuccessor() const {
+        return isEndMarker() || getInfo().isTerminal ? std::nullopt : std::optional{getNextOffset()};
+    }
+
+    /* Returns the jump target or the callee, it is not checked against the code section */
+    std::optional<std::int32_t> getBranchSuccessor() const {
+        return getInfo().isBranch ? std::optional{operands[0]} : std::nullopt;
+    }
+};
+
+/* Returns std::nullopt for unknown opcodes and instructions exceeding the code section */
+std::optional<Instruction> decodeInstruction(const lama::bytecode::BytecodeFile *file, offset_t offset);
+
+/*
+ * Iterates over consecutive instructions starting at the given offset. The iteration stops after the end marker
+ * and before an instruction which cannot be decoded. A default constructed iterator is the end of any iteration
+ */
+class InstructionIterator {
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Instruction;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Instruction*;
+    using reference = const Instruction&;
+
+    InstructionIterator() = default;
+
+    InstructionIterator(const lama::bytecode::BytecodeFile *file, offset_t offset)
+        : file_(file)
+        , instr_(decodeInstruction(file, offset)) {
+
+    }
+
+    reference operator*() const {
+        return *instr_;
+    }
+
+    pointer operator->() const {
+        return &*instr_;
+    }
+
+    InstructionIterator& operator++() {
+        instr_ = instr_->isEndMarker() ? std::nullopt : decodeInstruction(file_, instr_->getNextOffset());
+
+        return *this;
+    }
+
+    bool operator==(const InstructionIterator &other) const {
+        return instr_.has_value() == other.instr_.has_value()
+               && (!instr_ || instr_->offset == other.instr_->offset);
+    }
+private:
+    const lama::bytecode::BytecodeFile *file_ = nullptr;
+    std::optional<Instruction> instr_;
+};
+
+/* The stack effect of an instruction with its operands taken into account */
+struct StackEffect {
+    std::uint32_t pops;
+    std::uint32_t pushes;
+};
+
+/* Returns std::nullopt for unknown opcodes and instructions exceeding the code section */
+std::optional<std::uint32_t> getInstructionLength(const lama::bytecode::BytecodeFile *file, offset_t offset);
+
+/* Returns the code offset operand of jumps, calls and closures, the instruction must fit the code section */
 std::optional<std::int32_t> getJumpAddress(const lama::bytecode::BytecodeFile *file, offset_t offset);
+
+/*
+ * Returns std::nullopt if the effect depends on the runtime values (STA) or the number of words is negative.
+ * The instruction must fit the code section
+ */
+std::optional<StackEffect> getStackEffect(const lama::bytecode::BytecodeFile *file, offset_t offset);
 }
 
 #endif
@@ -5,6 +5,11 @@
 #include <cstdint>
 #include <new>
 #include <string_view>
+#include <utility>
+
+#ifdef LAMA_MMAP_LOADER
+#include <sys/mman.h>
+#endif
 
 namespace {
     std::int32_t findEntryPointOffset(const lama::bytecode::bytefile_t *bytefile) {
@@ -28,11 +33,29 @@ void lama::bytecode::detail::RawBytecodeFileDeleter::operator()(bytefile_t *byte
     ::operator delete[](reinterpret_cast<std::byte *>(bytefile), BYTEFILE_ALIGNMENT, std::nothrow);
 }
 
-lama::bytecode::BytecodeFile::BytecodeFile(std::string_view path, lama::bytecode::bytefile_t *bytefile, std::size_t codeSize)
+lama::bytecode::detail::FileMapping::FileMapping(const void *address, std::size_t size)
+    : address_(address)
+    , size_(size) {
+
+}
+
+lama::bytecode::detail::FileMapping::~FileMapping() {
+#ifdef LAMA_MMAP_LOADER
+    ::munmap(const_cast<void *>(address_), size_);
+#endif
+}
+
+lama::bytecode::BytecodeFile::BytecodeFile(
+    std::string_view path,
+    lama::bytecode::bytefile_t *bytefile,
+    std::size_t codeSize,
+    std::unique_ptr<detail::FileMapping> mapping
+)
     : path_(path)
     , codeSize_(codeSize)
-    , bytefile_(bytefile)
-    , entryPointOffset_(findEntryPointOffset(bytefile)) {
+    , entryPointOffset_(findEntryPointOffset(bytefile))
+    , mapping_(std::move(mapping))
+    , bytefile_(bytefile) {
 
 }
 
@@ -48,13 +71,6 @@ lama::bytecode::InstructionOpCode lama::bytecode::BytecodeFile::getInstruction(o
     return lama::bytecode::InstructionOpCode{static_cast<unsigned char>(getCodeByte(offset))};
 }
 
-std::size_t lama::bytecode::BytecodeFile::writeBytes(const std::byte *buffer, offset_t offset, std::size_t nbytes) {
-    std::byte * const start = &(bytefile_->code_ptr[offset]);
-    std::byte *last = std::copy_n(buffer, nbytes, start);
-
-    return last - start;
-}
-
 std::size_t lama::bytecode::BytecodeFile::copyCodeBytes(std::byte *buffer, offset_t offset, std::size_t nbytes) const {
     std::byte *last = std::copy_n(&(bytefile_->code_ptr[offset]), nbytes, buffer);
 
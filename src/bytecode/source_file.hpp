@@ -30,17 +30,50 @@ typedef struct {
 
 constexpr std::string_view ENTRYPOINT_NAME = LAMA_ENTRYPOINT_NAME;
 
+/*
+ * Bytecode files are mapped into memory read-only instead of being copied, if the platform supports mmap.
+ * Define LAMA_NO_MMAP to read them into a heap buffer.
+ */
+#if (defined(__APPLE__) || defined(__unix__)) && !defined(LAMA_NO_MMAP)
+#define LAMA_MMAP_LOADER
+#endif
+
 namespace detail {
 struct RawBytecodeFileDeleter {
     void operator()(bytefile_t *bytefile) const;
 };
+
+/* Read-only mapping of the whole bytecode file, the tables of a bytefile_t point into it */
+class FileMapping {
+public:
+    FileMapping(const void *address, std::size_t size);
+    FileMapping(const FileMapping &other) = delete;
+    FileMapping(FileMapping&& other) = delete;
+    ~FileMapping();
+
+    const std::byte* data() const {
+        return static_cast<const std::byte *>(address_);
+    }
+
+    std::size_t size() const {
+        return size_;
+    }
+private:
+    const void *address_;
+    std::size_t size_;
+};
 }
 
 using offset_t = std::uint32_t;
 
 class BytecodeFile {
 public:
-    BytecodeFile(std::string_view path, bytefile_t *bytefile, std::size_t codeSize);
+    BytecodeFile(
+        std::string_view path,
+        bytefile_t *bytefile,
+        std::size_t codeSize,
+        std::unique_ptr<detail::FileMapping> mapping = nullptr
+    );
     BytecodeFile(const BytecodeFile &other) = delete;
     BytecodeFile(BytecodeFile&& other) = default;
     ~BytecodeFile() = default;
@@ -51,7 +84,6 @@ public:
     const std::byte& getCodeByte(offset_t offset) const;
     lama::bytecode::InstructionOpCode getInstruction(offset_t offset) const;
 
-    std::size_t writeBytes(const std::byte *buffer, offset_t offset, std::size_t nbytes);
     std::size_t copyCodeBytes(std::byte *buffer, offset_t offset, std::size_t nbytes) const;
 
     std::uint32_t getStringTableSize() const;
@@ -71,6 +103,7 @@ private:
     const std::string_view path_;
     const std::size_t codeSize_;
     const std::int32_t entryPointOffset_;
+    std::unique_ptr<detail::FileMapping> mapping_;
     std::unique_ptr<bytefile_t, detail::RawBytecodeFileDeleter> bytefile_;
 };
 }
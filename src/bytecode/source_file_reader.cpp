@@ -11,6 +11,15 @@
 #include <string_view>
 #include <system_error>
 #include <unordered_map>
+#include <utility>
+
+#ifdef LAMA_MMAP_LOADER
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 namespace {
     constexpr std::align_val_t BYTEFILE_ALIGNMENT = std::align_val_t{alignof(lama::bytecode::bytefile_t)};
@@ -25,6 +34,7 @@ namespace {
         );
     }
 
+#ifndef LAMA_MMAP_LOADER
     bool readNBytesFromFileStream(std::ifstream &ifs, void *data, std::size_t nbytes) {
         ifs.read(static_cast<char *>(data), nbytes);
 
@@ -67,6 +77,173 @@ namespace {
             codeBufSize
         );
     }
+
+    lama::bytecode::read_bytefile_result_t readBytefile(const std::string_view path, std::size_t fileSize) {
+        lama::bytecode::bytefile_t *bc = allocateBytefile(fileSize);
+
+        if (bc == nullptr) {
+            return lama::bytecode::ReadBytefileError::OutOfMemoryError;
+        }
+
+        std::ifstream fis{path.data(), std::ios::binary};
+
+        #define ASSERTION(C, ERR) do { if (!(C)) { return ERR; } } while (false)
+
+        ASSERTION(
+            readFromFileStream(fis, bc->stringtab_size),
+            lama::bytecode::ReadBytefileError::WrongBytecodeFileError
+        );
+        ASSERTION(
+            bc->stringtab_size >= 0,
+            lama::bytecode::ReadBytefileError::WrongStringTableSize
+        );
+
+        ASSERTION(
+            readFromFileStream(fis, bc->global_area_size),
+            lama::bytecode::ReadBytefileError::WrongBytecodeFileError
+        );
+        ASSERTION(
+            bc->global_area_size >= 0,
+            lama::bytecode::ReadBytefileError::WrongGlobalAreaSize
+        );
+
+        ASSERTION(
+            readFromFileStream(fis, bc->public_symbols_number),
+            lama::bytecode::ReadBytefileError::WrongBytecodeFileError
+        );
+        ASSERTION(
+            bc->public_symbols_number >= 0,
+            lama::bytecode::ReadBytefileError::WrongPublicSymbolsNumber
+        );
+
+        bc->global_ptr = nullptr;
+
+        bc->public_ptr = reinterpret_cast<lama::bytecode::public_symbol_t *>(bc->buffer);
+        ASSERTION(
+            readPublicSymbolsTable(fis, bc),
+            lama::bytecode::ReadBytefileError::WrongBytecodeFileError
+        );
+
+        bc->string_ptr = reinterpret_cast<char *>(bc->public_ptr + bc->public_symbols_number);
+        ASSERTION(
+            readStringTable(fis, bc),
+            lama::bytecode::ReadBytefileError::WrongBytecodeFileError
+        );
+
+        bc->code_ptr = reinterpret_cast<std::byte *>(bc->string_ptr + bc->stringtab_size);
+        ASSERTION(
+            readCode(fis, bc, fileSize),
+            lama::bytecode::ReadBytefileError::WrongBytecodeFileError
+        );
+
+        return lama::bytecode::BytecodeFile{path, bc, getCodeBufSize(bc, fileSize)};
+    }
+
+    #undef ASSERTION
+#else
+    constexpr std::size_t HEADER_SIZE = 3 * sizeof(std::int32_t);
+
+    using raw_bytefile_ptr_t = std::unique_ptr<lama::bytecode::bytefile_t, lama::bytecode::detail::RawBytecodeFileDeleter>;
+
+    /*
+     * Maps the file read-only and points the tables of a separately allocated header into the mapping,
+     * so the file contents are neither copied nor modified and the pages are shared with other processes.
+     * The file is validated in the same order as by the stream reader
+     */
+    lama::bytecode::read_bytefile_result_t mapBytefile(const std::string_view path, std::size_t fileSize) {
+        if (fileSize == 0) {
+            return lama::bytecode::ReadBytefileError::WrongBytecodeFileError;
+        }
+
+        const int fd = ::open(path.data(), O_RDONLY);
+
+        if (fd < 0) {
+            return lama::bytecode::ReadBytefileError::ReadFileError;
+        }
+
+        void *address = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+
+        if (address == MAP_FAILED) {
+            return lama::bytecode::ReadBytefileError::ReadFileError;
+        }
+
+        auto mapping = std::make_unique<lama::bytecode::detail::FileMapping>(address, fileSize);
+        raw_bytefile_ptr_t bc{allocateBytefile(HEADER_SIZE)};
+
+        if (bc == nullptr) {
+            return lama::bytecode::ReadBytefileError::OutOfMemoryError;
+        }
+
+        std::byte *data = const_cast<std::byte *>(mapping->data());
+        std::size_t pos = 0;
+
+        const auto readInt32 = [&](std::int32_t &x) {
+            if (fileSize - pos < sizeof(x)) {
+                return false;
+            }
+
+            std::memcpy(&x, data + pos, sizeof(x));
+            pos += sizeof(x);
+
+            return true;
+        };
+
+        #define ASSERTION(C, ERR) do { if (!(C)) { return ERR; } } while (false)
+
+        ASSERTION(
+            readInt32(bc->stringtab_size),
+            lama::bytecode::ReadBytefileError::WrongBytecodeFileError
+        );
+        ASSERTION(
+            bc->stringtab_size >= 0,
+            lama::bytecode::ReadBytefileError::WrongStringTableSize
+        );
+
+        ASSERTION(
+            readInt32(bc->global_area_size),
+            lama::bytecode::ReadBytefileError::WrongBytecodeFileError
+        );
+        ASSERTION(
+            bc->global_area_size >= 0,
+            lama::bytecode::ReadBytefileError::WrongGlobalAreaSize
+        );
+
+        ASSERTION(
+            readInt32(bc->public_symbols_number),
+            lama::bytecode::ReadBytefileError::WrongBytecodeFileError
+        );
+        ASSERTION(
+            bc->public_symbols_number >= 0,
+            lama::bytecode::ReadBytefileError::WrongPublicSymbolsNumber
+        );
+
+        const std::size_t publicsSize = bc->public_symbols_number * sizeof(lama::bytecode::public_symbol_t);
+
+        ASSERTION(
+            fileSize - pos >= publicsSize,
+            lama::bytecode::ReadBytefileError::WrongBytecodeFileError
+        );
+
+        bc->global_ptr = nullptr;
+        bc->public_ptr = reinterpret_cast<lama::bytecode::public_symbol_t *>(data + pos);
+        pos += publicsSize;
+
+        ASSERTION(
+            fileSize - pos >= static_cast<std::size_t>(bc->stringtab_size),
+            lama::bytecode::ReadBytefileError::WrongBytecodeFileError
+        );
+
+        bc->string_ptr = reinterpret_cast<char *>(data + pos);
+        pos += bc->stringtab_size;
+
+        bc->code_ptr = data + pos;
+
+        #undef ASSERTION
+
+        return lama::bytecode::BytecodeFile{path, bc.release(), fileSize - pos, std::move(mapping)};
+    }
+#endif
 }
 
 std::string lama::bytecode::stringifyReadBytefileEror(lama::bytecode::ReadBytefileError err) {
@@ -103,62 +280,9 @@ lama::bytecode::read_bytefile_result_t lama::bytecode::readBytefileFromFile(cons
         return lama::bytecode::ReadBytefileError::ReadFileError;
     }
 
-    lama::bytecode::bytefile_t *bc = allocateBytefile(fileSize);
-
-    if (bc == nullptr) {
-        return lama::bytecode::ReadBytefileError::OutOfMemoryError;
-    }
-
-    std::ifstream fis{path.data(), std::ios::binary};
-
-    #define ASSERTION(C, ERR) do { if (!(C)) { return ERR; } } while (false)
-
-    ASSERTION(
-        readFromFileStream(fis, bc->stringtab_size),
-        lama::bytecode::ReadBytefileError::WrongBytecodeFileError
-    );
-    ASSERTION(
-        bc->stringtab_size >= 0,
-        lama::bytecode::ReadBytefileError::WrongStringTableSize
-    );
-
-    ASSERTION(
-        readFromFileStream(fis, bc->global_area_size),
-        lama::bytecode::ReadBytefileError::WrongBytecodeFileError
-    );
-    ASSERTION(
-        bc->global_area_size >= 0,
-        lama::bytecode::ReadBytefileError::WrongGlobalAreaSize
-    );
-
-    ASSERTION(
-        readFromFileStream(fis, bc->public_symbols_number),
-        lama::bytecode::ReadBytefileError::WrongBytecodeFileError
-    );
-    ASSERTION(
-        bc->public_symbols_number >= 0,
-        lama::bytecode::ReadBytefileError::WrongPublicSymbolsNumber
-    );
-
-    bc->global_ptr = nullptr;
-
-    bc->public_ptr = reinterpret_cast<lama::bytecode::public_symbol_t *>(bc->buffer);
-    ASSERTION(
-        readPublicSymbolsTable(fis, bc),
-        lama::bytecode::ReadBytefileError::WrongBytecodeFileError
-    );
-
-    bc->string_ptr = reinterpret_cast<char *>(bc->public_ptr + bc->public_symbols_number);
-    ASSERTION(
-        readStringTable(fis, bc),
-        lama::bytecode::ReadBytefileError::WrongBytecodeFileError
-    );
-
-    bc->code_ptr = reinterpret_cast<std::byte *>(bc->string_ptr + bc->stringtab_size);
-    ASSERTION(
-        readCode(fis, bc, fileSize),
-        lama::bytecode::ReadBytefileError::WrongBytecodeFileError
-    );
-
-    return BytecodeFile{path, bc, getCodeBufSize(bc, fileSize)};
+#ifdef LAMA_MMAP_LOADER
+    return mapBytefile(path, fileSize);
+#else
+    return readBytefile(path, fileSize);
+#endif
 }
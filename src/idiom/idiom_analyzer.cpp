@@ -1,12 +1,12 @@
 #include "idiom_analyzer.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cstdint>
-#include <cstdio>
 #include <cstdlib>
-#include <cstring>
 #include <ios>
 #include <iostream>
+#include <iterator>
 #include <optional>
 #include <stack>
 #include <string_view>
@@ -16,49 +16,23 @@
 #include "../bytecode/decoder.hpp"
 #include "../bytecode/source_file.hpp"
 
-extern "C" {
-    int32_t disassemble_instruction(FILE *f, const lama::bytecode::bytefile_t *bf, uint32_t offset);
-}
-
 namespace {
-    bool isJumpInstr(lama::bytecode::InstructionOpCode opcode) {
-        return opcode == lama::bytecode::InstructionOpCode::JMP
-               || opcode == lama::bytecode::InstructionOpCode::CJMPZ
-               || opcode == lama::bytecode::InstructionOpCode::CJMPNZ
-               || opcode == lama::bytecode::InstructionOpCode::CALL // CALLC performs jump too, but has no explicit jump address
-               ;
+    bool isBreakingBytecodeSequenceInstr(const lama::bytecode::decoder::Instruction &instr) {
+        return !instr.getFallThroughSuccessor() || instr.getInfo().isCall;
     }
 
-    bool isCallInstr(lama::bytecode::InstructionOpCode opcode) {
-        return opcode == lama::bytecode::InstructionOpCode::CALL
-               || opcode == lama::bytecode::InstructionOpCode::CALLC
-               ;
-    }
+    /* The key of an instruction with operands of a class is its opcode followed by the class */
+    constexpr std::size_t CLASS_KEY_SIZE = 2;
 
-    bool isTerminalInstr(lama::bytecode::InstructionOpCode opcode) {
-        return opcode == lama::bytecode::InstructionOpCode::JMP
-               || opcode == lama::bytecode::InstructionOpCode::RET
-               || opcode == lama::bytecode::InstructionOpCode::END
-               || opcode == lama::bytecode::InstructionOpCode::FAIL
-               ;
-    }
+    constexpr auto CLASS_KEYS = []() {
+        std::array<std::array<char, CLASS_KEY_SIZE>, 256 * lama::idiom::OPERAND_CLASSES_NUMBER> keys{};
 
-    bool isBreakingBytecodeSequenceInstr(lama::bytecode::InstructionOpCode opcode) {
-        return opcode == lama::bytecode::InstructionOpCode::JMP
-               || opcode == lama::bytecode::InstructionOpCode::CALL
-               || opcode == lama::bytecode::InstructionOpCode::CALLC
-               || opcode == lama::bytecode::InstructionOpCode::RET
-               || opcode == lama::bytecode::InstructionOpCode::END
-               || opcode == lama::bytecode::InstructionOpCode::FAIL
-               ;
-    }
-
-    int compareIdioms(const lama::bytecode::BytecodeFile *file, const lama::idiom::idiom_record_t &r1, const lama::idiom::idiom_record_t &r2) {
-        const std::byte * const ptr1 = &file->getCodeByte(r1.first);
-        const std::byte * const ptr2 = &file->getCodeByte(r2.first);
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            keys[i] = {static_cast<char>(i / lama::idiom::OPERAND_CLASSES_NUMBER), static_cast<char>(i % lama::idiom::OPERAND_CLASSES_NUMBER)};
+        }
 
-        return std::memcmp(ptr1, ptr2, r1.second);
-    }
+        return keys;
+    }();
 
     void assertCodeOffset(lama::bytecode::offset_t offset, std::size_t codeSize) {
         if (offset >= codeSize) {
@@ -80,9 +54,20 @@ namespace {
         }
     }
 
-    void checkInstruction(std::int32_t instrLen, lama::bytecode::offset_t ip) {
-        assertWithIp(instrLen >= 0, "invalid opcode", ip);
-        assertWithIp(instrLen > 0, "unexpected end of code section", ip);
+    /* The end marker is reachable if the last instruction falls through, it is counted as an idiom */
+    lama::bytecode::decoder::Instruction decodeReachableInstruction(const lama::bytecode::BytecodeFile *file, lama::bytecode::offset_t ip) {
+        const lama::bytecode::InstructionOpCode opcode = file->getInstruction(ip);
+
+        assertWithIp(
+            lama::bytecode::isValidInstruction(opcode) || static_cast<unsigned char>(opcode) == lama::bytecode::CODE_END_MARKER,
+            "invalid opcode",
+            ip
+        );
+
+        const std::optional<lama::bytecode::decoder::Instruction> instr = lama::bytecode::decoder::decodeInstruction(file, ip);
+        assertWithIp(instr.has_value(), "unexpected end of code section", ip);
+
+        return *instr;
     }
 }
 
@@ -114,48 +99,44 @@ void lama::idiom::detail::IdiomAnalyzer::preprocess() {
         instructionsToProcess.pop();
 
         reachableInstrs_[instrPos] = true;
-        const lama::bytecode::InstructionOpCode op = bytecodeFile_->getInstruction(instrPos);
+        const lama::bytecode::decoder::Instruction instr = decodeReachableInstruction(bytecodeFile_, instrPos);
 
-        const std::int32_t instrLen = ::disassemble_instruction(stdin, bytecodeFile_->getRawBytefile(), instrPos);
-        checkInstruction(instrLen, instrPos);
+        // CALLC performs jump too, but has no explicit jump address
+        if (const std::optional<std::int32_t> jumpTarget = instr.getBranchSuccessor()) {
+            assertWithIp(*jumpTarget >= 0 && static_cast<std::size_t>(*jumpTarget) < bytecodeFile_->getCodeSize(), "wrong jump", instrPos);
 
-        if (isJumpInstr(op)) {
-            const std::int32_t jumpTarget = lama::bytecode::decoder::getJumpAddress(bytecodeFile_, instrPos).value();
-            assertWithIp(jumpTarget >= 0 && jumpTarget < bytecodeFile_->getCodeSize(), "wrong jump", instrPos);
+            labeled_[*jumpTarget] = true;
 
-            labeled_[jumpTarget] = true;
-
-            if (!reachableInstrs_[jumpTarget]) {
-                reachableInstrs_[jumpTarget] = true;
-                instructionsToProcess.push(jumpTarget);
+            if (!reachableInstrs_[*jumpTarget]) {
+                reachableInstrs_[*jumpTarget] = true;
+                instructionsToProcess.push(*jumpTarget);
             }
         }
 
-        if (!isTerminalInstr(op)) {
-            const lama::bytecode::offset_t nextInstrPos = instrPos + instrLen;
-
-            if (nextInstrPos < bytecodeFile_->getCodeSize()) {
-                if (!reachableInstrs_[nextInstrPos]) {
-                    reachableInstrs_[nextInstrPos] = true;
-                    instructionsToProcess.push(nextInstrPos);
+        if (const std::optional<lama::bytecode::offset_t> nextInstrPos = instr.getFallThroughSuccessor()) {
+            if (*nextInstrPos < bytecodeFile_->getCodeSize()) {
+                if (!reachableInstrs_[*nextInstrPos]) {
+                    reachableInstrs_[*nextInstrPos] = true;
+                    instructionsToProcess.push(*nextInstrPos);
                 }
 
-                if (isCallInstr(op)) {
-                    labeled_[nextInstrPos] = true;
+                if (instr.getInfo().isCall) {
+                    labeled_[*nextInstrPos] = true;
                 }
             }
         }
     }
 }
 
-void lama::idiom::detail::IdiomAnalyzer::findIdioms(
-    std::vector<idiom_record_t> &idioms1,
-    std::vector<idiom_record_t> &idioms2
+template<class Weight>
+std::vector<lama::idiom::detail::IdiomFrequency> lama::idiom::detail::IdiomAnalyzer::collectIdioms(
+    std::uint32_t maxIdiomLength,
+    OperandsGrouping grouping,
+    Weight &&weight
 ) {
     preprocess();
 
-    idioms1.reserve(bytecodeFile_->getCodeSize());
-    idioms2.reserve(bytecodeFile_->getCodeSize());
+    IdiomTrie trie{bytecodeFile_->getCodeSize()};
 
     lama::bytecode::offset_t ip = 0;
 
@@ -165,54 +146,139 @@ void lama::idiom::detail::IdiomAnalyzer::findIdioms(
             continue;
         }
 
-        const lama::bytecode::InstructionOpCode op = bytecodeFile_->getInstruction(ip);
-        const std::int32_t instrLen = ::disassemble_instruction(stdin, bytecodeFile_->getRawBytefile(), ip);
-        checkInstruction(instrLen, ip);
+        // reachable instructions have been decoded by the preprocessing, so the iteration cannot stop early
+        lama::bytecode::decoder::InstructionIterator instrIt{bytecodeFile_, ip};
+        const std::uint32_t instrLen = instrIt->length;
 
-        idioms1.push_back({ip, instrLen});
+        IdiomTrie::node_t node = IdiomTrie::ROOT;
 
-        const lama::bytecode::offset_t nextInstrPos = ip + instrLen;
+        for (std::uint32_t instrsNumber = 1; ; ++instrsNumber, ++instrIt) {
+            const std::uint64_t freq = weight(ip, instrsNumber);
 
-        if (nextInstrPos < bytecodeFile_->getCodeSize() && !isBreakingBytecodeSequenceInstr(op)) {
-            if (!labeled_[nextInstrPos] && reachableInstrs_[nextInstrPos]) {
-                const std::int32_t nextInstrLen = ::disassemble_instruction(stdin, bytecodeFile_->getRawBytefile(), nextInstrPos);
-                checkInstruction(nextInstrLen, nextInstrPos);
+            // a sequence is never more frequent than its prefix
+            if (freq == 0) {
+                break;
+            }
 
-                idioms2.push_back({ip, instrLen + nextInstrLen});
+            const lama::bytecode::offset_t nextInstrPos = instrIt->getNextOffset();
+
+            node = trie.addOccurrence(node, getInstructionKey(bytecodeFile_, *instrIt, grouping), ip, nextInstrPos - ip, freq);
+
+            if (instrsNumber >= maxIdiomLength
+                || nextInstrPos >= bytecodeFile_->getCodeSize()
+                || isBreakingBytecodeSequenceInstr(*instrIt)
+                || labeled_[nextInstrPos]
+                || !reachableInstrs_[nextInstrPos]) {
+                break;
             }
         }
 
         ip += instrLen;
     }
+
+    return trie.getFrequencies();
 }
 
-void lama::idiom::detail::collectFrequencies(
-    const bytecode::BytecodeFile *file,
-    std::vector<idiom_record_t> &idioms
+std::vector<lama::idiom::detail::IdiomFrequency> lama::idiom::detail::IdiomAnalyzer::findIdioms(
+    std::uint32_t maxIdiomLength,
+    OperandsGrouping grouping
 ) {
-    std::sort(idioms.begin(), idioms.end(), [file](const idiom_record_t &r1, const idiom_record_t &r2) {
-        return compareIdioms(file, r1, r2) < 0;
+    return collectIdioms(maxIdiomLength, grouping, [](lama::bytecode::offset_t, std::uint32_t) -> std::uint64_t {
+        return 1;
     });
+}
 
-    std::uint32_t freq = 1;
-    std::uint32_t uniqIdioms = 0;
+std::vector<lama::idiom::detail::IdiomFrequency> lama::idiom::detail::IdiomAnalyzer::findExecutedIdioms(
+    const lama::interpreter::ExecutionProfile &profile
+) {
+    return collectIdioms(2, OperandsGrouping::EXACT, [&profile](lama::bytecode::offset_t ip, std::uint32_t instrsNumber) {
+        return instrsNumber == 1 ? profile.getExecutionsCount(ip) : profile.getFallThroughsCount(ip);
+    });
+}
 
-    for (std::uint32_t i = 1; i < idioms.size(); ++i) {
-        const std::uint32_t span1Len = idioms[i - 1].second;
-        const std::uint32_t span2Len = idioms[i].second;
+lama::idiom::detail::IdiomTrie::IdiomTrie(std::size_t capacity)
+    : nodes_(1) {
+    nodes_.reserve(capacity + 1);
+    edges_.reserve(capacity);
+}
 
-        if (compareIdioms(file, { idioms[i - 1].first, span1Len }, { idioms[i].first, span2Len }) == 0) {
-            freq++;
-        } else {
-            idioms[uniqIdioms++] = { idioms[i - 1].first, freq };
-            freq = 1;
-        }
+lama::idiom::detail::IdiomTrie::node_t lama::idiom::detail::IdiomTrie::addOccurrence(
+    node_t parent,
+    std::string_view instrKey,
+    lama::bytecode::offset_t sequenceBegin,
+    std::uint32_t sequenceSize,
+    std::uint64_t freq
+) {
+    const auto [it, inserted] = edges_.try_emplace({parent, instrKey}, nodes_.size());
+    const node_t child = it->second;
+
+    // the first occurrence represents the sequence
+    if (inserted) {
+        nodes_.push_back({sequenceBegin, nodes_[parent].instrsNumber + 1, sequenceSize, 0});
     }
 
-    idioms[uniqIdioms++] = { idioms.back().first, freq };
-    idioms.resize(uniqIdioms);
+    nodes_[child].freq += freq;
 
-    std::sort(idioms.begin(), idioms.end(), [](const idiom_record_t &r1, const idiom_record_t &r2){
-        return r1.second > r2.second;
-    });
+    return child;
+}
+
+std::vector<lama::idiom::detail::IdiomFrequency> lama::idiom::detail::IdiomTrie::getFrequencies() const {
+    // nodes are created in the order of first occurrences
+    std::vector<IdiomFrequency> idioms{std::next(nodes_.begin()), nodes_.end()};
+
+    std::stable_sort(idioms.begin(), idioms.end(), isRankedHigher);
+
+    return idioms;
+}
+
+bool lama::idiom::detail::isRankedHigher(const IdiomFrequency &idiom1, const IdiomFrequency &idiom2) {
+    if (idiom1.freq != idiom2.freq) {
+        return idiom1.freq > idiom2.freq;
+    }
+
+    return idiom1.instrsNumber > idiom2.instrsNumber;
+}
+
+lama::idiom::OperandClass lama::idiom::getOperandClass(const bytecode::decoder::Instruction &instr) {
+    if (instr.opcode != lama::bytecode::InstructionOpCode::CONST) {
+        return OperandClass::NONE;
+    }
+
+    const std::int32_t value = instr.operands[0];
+
+    if (value == 0) {
+        return OperandClass::ZERO_CONSTANT;
+    }
+
+    return value >= MIN_SMALL_CONSTANT && value <= MAX_SMALL_CONSTANT ? OperandClass::SMALL_CONSTANT : OperandClass::LARGE_CONSTANT;
+}
+
+std::string_view lama::idiom::stringifyOperandClass(OperandClass operandClass) {
+    switch (operandClass) {
+        case OperandClass::NONE:
+            return "";
+        case OperandClass::ZERO_CONSTANT:
+            return "zero";
+        case OperandClass::SMALL_CONSTANT:
+            return "small";
+        case OperandClass::LARGE_CONSTANT:
+            return "large";
+    }
+
+    return "";
+}
+
+std::string_view lama::idiom::detail::getInstructionKey(
+    const bytecode::BytecodeFile *file,
+    const bytecode::decoder::Instruction &instr,
+    OperandsGrouping grouping
+) {
+    if (grouping == OperandsGrouping::EXACT) {
+        return {reinterpret_cast<const char *>(&file->getCodeByte(instr.offset)), instr.length};
+    }
+
+    const std::size_t keyIndex = static_cast<unsigned char>(instr.opcode) * OPERAND_CLASSES_NUMBER
+        + static_cast<std::size_t>(getOperandClass(instr));
+
+    return {CLASS_KEYS[keyIndex].data(), CLASS_KEY_SIZE};
 }
@@ -1,15 +1,119 @@
 #ifndef BYTECODE_IDIOM_ANALYZER_HPP
 #define BYTECODE_IDIOM_ANALYZER_HPP
 
+#include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "../bytecode/decoder.hpp"
 #include "../bytecode/source_file.hpp"
+#include "../interpreter/execution_profile.hpp"
 
 namespace lama::idiom {
+    /* An idiom span is the code offset of the first instruction and the number of instructions */
     using idiom_record_t = std::pair<lama::bytecode::offset_t, std::uint32_t>;
 
+    inline constexpr std::uint32_t DEFAULT_MAX_IDIOM_LENGTH = 2;
+
+    /* Constants in [MIN_SMALL_CONSTANT, MAX_SMALL_CONSTANT] fit in a signed byte */
+    inline constexpr std::int32_t MIN_SMALL_CONSTANT = -128;
+    inline constexpr std::int32_t MAX_SMALL_CONSTANT = 127;
+
+    /* How occurrences of instruction sequences are grouped into idioms */
+    enum class OperandsGrouping {
+        /* Sequences are equal if their bytes are equal */
+        EXACT,
+        /*
+         * Sequences are equal if their opcodes and operand classes are equal. The kind of a variable
+         * (global, local, argument or captured) is defined by the opcode, so only constants are classified,
+         * the other operands are ignored
+         */
+        CLASSES,
+    };
+
+    enum class OperandClass : unsigned char {
+        /* The operands are ignored */
+        NONE,
+        ZERO_CONSTANT,
+        SMALL_CONSTANT,
+        LARGE_CONSTANT,
+    };
+
+    inline constexpr std::size_t OPERAND_CLASSES_NUMBER = 4;
+
+    OperandClass getOperandClass(const bytecode::decoder::Instruction &instr);
+
+    /* Returns an empty string for OperandClass::NONE */
+    std::string_view stringifyOperandClass(OperandClass operandClass);
+
     namespace detail {
+        struct IdiomFrequency {
+            lama::bytecode::offset_t offset;
+            std::uint32_t instrsNumber;
+            /* The number of bytes of the instructions */
+            std::uint32_t size;
+            std::uint64_t freq;
+        };
+
+        /* More frequent idioms go first, ties are ordered by the number of instructions descending */
+        bool isRankedHigher(const IdiomFrequency &idiom1, const IdiomFrequency &idiom2);
+
+        /*
+         * Returns the key instructions are compared by: their bytes or their opcode and operand class.
+         * The key refers either to the code of the file or to static storage
+         */
+        std::string_view getInstructionKey(
+            const bytecode::BytecodeFile *file,
+            const bytecode::decoder::Instruction &instr,
+            OperandsGrouping grouping
+        );
+
+        /*
+         * Sequences of consecutive instructions are counted in a trie, a node of depth N stands for a unique sequence
+         * of N instructions. Edges of all nodes are kept in one hash table keyed by the parent node and the key of the next instruction
+         */
+        class IdiomTrie {
+        public:
+            using node_t = std::uint32_t;
+
+            static constexpr node_t ROOT = 0;
+
+            /* The capacity is a hint of the number of nodes */
+            explicit IdiomTrie(std::size_t capacity);
+
+            /* Adds the frequency of an occurrence of the child sequence of sequenceSize bytes and returns its node */
+            node_t addOccurrence(
+                node_t parent,
+                std::string_view instrKey,
+                lama::bytecode::offset_t sequenceBegin,
+                std::uint32_t sequenceSize,
+                std::uint64_t freq
+            );
+
+            /* Idioms sorted by frequency, ties are ordered by the number of instructions descending and by the first occurrence */
+            std::vector<IdiomFrequency> getFrequencies() const;
+        private:
+            struct Edge {
+                node_t parent;
+                std::string_view instrKey;
+
+                bool operator==(const Edge &) const = default;
+            };
+
+            struct EdgeHash {
+                std::size_t operator()(const Edge &edge) const {
+                    return std::hash<std::string_view>{}(edge.instrKey) ^ (std::size_t{edge.parent} * 0x9e3779b97f4a7c15);
+                }
+            };
+
+            std::vector<IdiomFrequency> nodes_;
+            std::unordered_map<Edge, node_t, EdgeHash> edges_;
+        };
+
         class IdiomAnalyzer {
         public:
             IdiomAnalyzer(const bytecode::BytecodeFile *file);
@@ -17,63 +121,50 @@ namespace lama::idiom {
             IdiomAnalyzer(IdiomAnalyzer&&) = default;
             ~IdiomAnalyzer() = default;
 
-            void findIdioms(std::vector<idiom_record_t> &idioms1, std::vector<idiom_record_t> &idioms2);
+            /* Finds sequences of 1 to maxIdiomLength instructions which do not cross basic blocks boundaries */
+            std::vector<IdiomFrequency> findIdioms(std::uint32_t maxIdiomLength, OperandsGrouping grouping = OperandsGrouping::EXACT);
+
+            /* Same as findIdioms of 1 and 2 instructions, but each occurrence is weighted by its execution count */
+            std::vector<IdiomFrequency> findExecutedIdioms(const lama::interpreter::ExecutionProfile &profile);
         private:
             const bytecode::BytecodeFile *bytecodeFile_;
             std::vector<bool> reachableInstrs_;
             std::vector<bool> labeled_;
 
             void preprocess();
-        };
 
-        void collectFrequencies(const bytecode::BytecodeFile *file, std::vector<idiom_record_t> &idioms);
+            /* The weight of an occurrence is a function of its code offset and the number of instructions */
+            template<class Weight>
+            std::vector<IdiomFrequency> collectIdioms(std::uint32_t maxIdiomLength, OperandsGrouping grouping, Weight &&weight);
+        };
     }
 
+    /* An idiom is passed as its first occurrence, with OperandsGrouping::CLASSES its operands stand for their classes */
     template<class Func>
-    void processIdiomsFrequencies(const bytecode::BytecodeFile *file, Func &&func) {
+    void processIdiomsFrequencies(
+        const bytecode::BytecodeFile *file,
+        Func &&func,
+        std::uint32_t maxIdiomLength = DEFAULT_MAX_IDIOM_LENGTH,
+        OperandsGrouping grouping = OperandsGrouping::EXACT
+    ) {
         detail::IdiomAnalyzer analyzer{file};
-        std::vector<idiom_record_t> idioms1, idioms2;
-        analyzer.findIdioms(idioms1, idioms2);
-
-        detail::collectFrequencies(file, idioms1);
-        detail::collectFrequencies(file, idioms2);
-
-        std::size_t ptr1 = 0, ptr2 = 0;
-
-        while (ptr1 < idioms1.size() || ptr2 < idioms2.size()) {
-            std::uint32_t instrAddr;
-            std::uint32_t instrsNum;
-            std::uint32_t freq;
 
-            if (ptr1 < idioms1.size() && ptr2 < idioms2.size()) {
-                if (idioms1[ptr1].second > idioms2[ptr2].second) {
-                    instrAddr = idioms1[ptr1].first;
-                    freq = idioms1[ptr1].second;
-                    instrsNum = 1;
-
-                    ++ptr1;
-                } else {
-                    instrAddr = idioms2[ptr2].first;
-                    freq = idioms2[ptr2].second;
-                    instrsNum = 2;
-
-                    ++ptr2;
-                }
-            } else if (ptr1 < idioms1.size()) {
-                instrAddr = idioms1[ptr1].first;
-                freq = idioms1[ptr1].second;
-                instrsNum = 1;
-
-                ++ptr1;
-            } else {
-                instrAddr = idioms2[ptr2].first;
-                freq = idioms2[ptr2].second;
-                instrsNum = 2;
+        for (const detail::IdiomFrequency &idiom : analyzer.findIdioms(maxIdiomLength, grouping)) {
+            func({idiom.offset, idiom.instrsNumber}, idiom.freq);
+        }
+    }
 
-                ++ptr2;
-            }
+    /* Idioms of the code executed with the profile, never executed idioms are skipped */
+    template<class Func>
+    void processExecutedIdiomsFrequencies(
+        const bytecode::BytecodeFile *file,
+        const lama::interpreter::ExecutionProfile &profile,
+        Func &&func
+    ) {
+        detail::IdiomAnalyzer analyzer{file};
 
-            func({instrAddr, instrsNum}, freq);
+        for (const detail::IdiomFrequency &idiom : analyzer.findExecutedIdioms(profile)) {
+            func({idiom.offset, idiom.instrsNumber}, idiom.freq);
         }
     }
 }
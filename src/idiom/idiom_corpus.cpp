@@ -0,0 +1,135 @@
+#include "idiom_corpus.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    using lama::idiom::detail::IdiomFrequency;
+
+    std::size_t getAnalyzerThreadsNumber(std::size_t filesNumber) {
+        std::size_t threadsNumber = lama::idiom::IDIOM_ANALYZER_THREADS;
+
+        if (threadsNumber == 0) {
+            threadsNumber = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        return std::max<std::size_t>(1, std::min(threadsNumber, filesNumber));
+    }
+
+    /* Keys of grouped idioms are built from the keys of their instructions and kept in the storage */
+    std::string_view getIdiomKey(
+        const lama::bytecode::BytecodeFile *file,
+        const IdiomFrequency &idiom,
+        lama::idiom::OperandsGrouping grouping,
+        std::deque<std::string> &keysStorage
+    ) {
+        if (grouping == lama::idiom::OperandsGrouping::EXACT) {
+            return {reinterpret_cast<const char *>(&file->getCodeByte(idiom.offset)), idiom.size};
+        }
+
+        std::string &key = keysStorage.emplace_back();
+        lama::bytecode::decoder::InstructionIterator instrIt{file, idiom.offset};
+
+        for (std::uint32_t i = 0; i < idiom.instrsNumber; ++i, ++instrIt) {
+            key += lama::idiom::detail::getInstructionKey(file, *instrIt, grouping);
+        }
+
+        return key;
+    }
+
+    /* Files are distributed dynamically, the calling thread is one of the workers */
+    std::vector<std::vector<IdiomFrequency>> analyzeFiles(
+        const std::vector<const lama::bytecode::BytecodeFile *> &files,
+        std::uint32_t maxIdiomLength,
+        lama::idiom::OperandsGrouping grouping
+    ) {
+        std::vector<std::vector<IdiomFrequency>> fileIdioms(files.size());
+        std::atomic<std::size_t> nextFile = 0;
+
+        const auto work = [&files, &fileIdioms, &nextFile, maxIdiomLength, grouping]() {
+            for (std::size_t i = nextFile.fetch_add(1); i < files.size(); i = nextFile.fetch_add(1)) {
+                lama::idiom::detail::IdiomAnalyzer analyzer{files[i]};
+                fileIdioms[i] = analyzer.findIdioms(maxIdiomLength, grouping);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        const std::size_t threadsNumber = getAnalyzerThreadsNumber(files.size());
+        threads.reserve(threadsNumber - 1);
+
+        for (std::size_t worker = 1; worker < threadsNumber; ++worker) {
+            threads.emplace_back(work);
+        }
+
+        work();
+
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+
+        return fileIdioms;
+    }
+}
+
+std::vector<lama::idiom::CorpusIdiomFrequency> lama::idiom::findCorpusIdioms(
+    const std::vector<const bytecode::BytecodeFile *> &files,
+    std::uint32_t maxIdiomLength,
+    OperandsGrouping grouping
+) {
+    const std::vector<std::vector<IdiomFrequency>> fileIdioms = analyzeFiles(files, maxIdiomLength, grouping);
+
+    std::size_t idiomsNumber = 0;
+
+    for (const std::vector<IdiomFrequency> &idioms : fileIdioms) {
+        idiomsNumber += idioms.size();
+    }
+
+    /*
+     * Files are merged in their order after all of them are analyzed, so the ranking does not depend on the scheduling.
+     * The merged idioms keep their offsets in the file they are taken from
+     */
+    struct MergedIdiom {
+        IdiomFrequency idiom;
+        std::size_t fileIndex;
+    };
+
+    std::deque<std::string> keysStorage;
+    std::unordered_map<std::string_view, std::size_t> uniqIndices;
+    uniqIndices.reserve(idiomsNumber);
+
+    std::vector<MergedIdiom> uniqIdioms;
+
+    for (std::size_t fileIndex = 0; fileIndex < files.size(); ++fileIndex) {
+        for (const IdiomFrequency &idiom : fileIdioms[fileIndex]) {
+            const auto [it, inserted] = uniqIndices.try_emplace(
+                getIdiomKey(files[fileIndex], idiom, grouping, keysStorage),
+                uniqIdioms.size()
+            );
+
+            if (inserted) {
+                uniqIdioms.push_back({idiom, fileIndex});
+            } else {
+                uniqIdioms[it->second].idiom.freq += idiom.freq;
+            }
+        }
+    }
+
+    std::stable_sort(uniqIdioms.begin(), uniqIdioms.end(), [](const MergedIdiom &merged1, const MergedIdiom &merged2) {
+        return detail::isRankedHigher(merged1.idiom, merged2.idiom);
+    });
+
+    std::vector<CorpusIdiomFrequency> result;
+    result.reserve(uniqIdioms.size());
+
+    for (auto&& [idiom, fileIndex] : uniqIdioms) {
+        result.push_back({fileIndex, {idiom.offset, idiom.instrsNumber}, idiom.freq});
+    }
+
+    return result;
+}
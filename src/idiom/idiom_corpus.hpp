@@ -0,0 +1,51 @@
+#ifndef IDIOM_IDIOM_CORPUS_HPP
+#define IDIOM_IDIOM_CORPUS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "idiom_analyzer.hpp"
+
+#include "../bytecode/source_file.hpp"
+
+namespace lama::idiom {
+#ifndef LAMA_IDIOM_ANALYZER_THREADS
+#define LAMA_IDIOM_ANALYZER_THREADS 0
+#endif
+
+constexpr std::size_t IDIOM_ANALYZER_THREADS = LAMA_IDIOM_ANALYZER_THREADS;
+
+/* An idiom of a corpus is represented by its first occurrence in the first file containing it */
+struct CorpusIdiomFrequency {
+    std::size_t fileIndex;
+    idiom_record_t span;
+    std::uint64_t freq;
+};
+
+/*
+ * Finds idioms of every file on a pool of threads, one IdiomAnalyzer per file, and merges their frequencies.
+ * Idioms of different files are compared as idioms of a single file (see OperandsGrouping),
+ * the ranking is ordered as the ranking of a single file.
+ * LAMA_IDIOM_ANALYZER_THREADS limits the number of threads (0 means the number of hardware threads)
+ */
+std::vector<CorpusIdiomFrequency> findCorpusIdioms(
+    const std::vector<const bytecode::BytecodeFile *> &files,
+    std::uint32_t maxIdiomLength = DEFAULT_MAX_IDIOM_LENGTH,
+    OperandsGrouping grouping = OperandsGrouping::EXACT
+);
+
+template<class Func>
+void processCorpusIdiomsFrequencies(
+    const std::vector<const bytecode::BytecodeFile *> &files,
+    Func &&func,
+    std::uint32_t maxIdiomLength = DEFAULT_MAX_IDIOM_LENGTH,
+    OperandsGrouping grouping = OperandsGrouping::EXACT
+) {
+    for (const CorpusIdiomFrequency &idiom : findCorpusIdioms(files, maxIdiomLength, grouping)) {
+        func(files[idiom.fileIndex], idiom.span, idiom.freq);
+    }
+}
+}
+
+#endif
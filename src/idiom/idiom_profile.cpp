@@ -0,0 +1,151 @@
+#include "idiom_profile.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <ios>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "idiom_analyzer.hpp"
+#include "idiom_corpus.hpp"
+
+#include "../bytecode/decoder.hpp"
+
+namespace {
+    using lama::bytecode::InstructionOpCode;
+
+    /* Ordered map keeps the profile deterministic for pairs of equal frequency */
+    using pair_frequencies_t = std::map<std::pair<InstructionOpCode, InstructionOpCode>, std::uint64_t>;
+
+    void addPairFrequency(
+        pair_frequencies_t &pairFrequencies,
+        const lama::bytecode::BytecodeFile *file,
+        const lama::idiom::idiom_record_t &span,
+        std::uint64_t freq
+    ) {
+        const auto [offset, instrNum] = span;
+
+        if (instrNum != 2) {
+            return;
+        }
+
+        // idioms consist of valid instructions
+        lama::bytecode::decoder::InstructionIterator instrIt{file, offset};
+
+        const InstructionOpCode first = instrIt->opcode;
+        const InstructionOpCode second = (++instrIt)->opcode;
+
+        pairFrequencies[{first, second}] += freq;
+    }
+
+    lama::idiom::IdiomProfile makeIdiomProfile(const pair_frequencies_t &pairFrequencies) {
+        lama::idiom::IdiomProfile profile;
+        profile.reserve(pairFrequencies.size());
+
+        for (auto&& [pair, freq] : pairFrequencies) {
+            profile.push_back({pair.first, pair.second, freq});
+        }
+
+        std::stable_sort(profile.begin(), profile.end(), [](const lama::idiom::InstructionPairFrequency &p1, const lama::idiom::InstructionPairFrequency &p2) {
+            return p1.freq > p2.freq;
+        });
+
+        return profile;
+    }
+}
+
+lama::idiom::IdiomProfile lama::idiom::buildIdiomProfile(const lama::bytecode::BytecodeFile *file) {
+    pair_frequencies_t pairFrequencies;
+
+    processIdiomsFrequencies(file, [file, &pairFrequencies](const idiom_record_t &span, std::uint64_t freq) {
+        addPairFrequency(pairFrequencies, file, span, freq);
+    });
+
+    return makeIdiomProfile(pairFrequencies);
+}
+
+lama::idiom::IdiomProfile lama::idiom::buildCorpusIdiomProfile(const std::vector<const lama::bytecode::BytecodeFile *> &files) {
+    pair_frequencies_t pairFrequencies;
+
+    processCorpusIdiomsFrequencies(files, [&pairFrequencies](const bytecode::BytecodeFile *file, const idiom_record_t &span, std::uint64_t freq) {
+        addPairFrequency(pairFrequencies, file, span, freq);
+    });
+
+    return makeIdiomProfile(pairFrequencies);
+}
+
+void lama::idiom::writeIdiomProfile(std::ostream &os, const IdiomProfile &profile) {
+    os << "# frequency, first instruction, second instruction\n";
+
+    for (const InstructionPairFrequency &pair : profile) {
+        os << pair.freq << ' '
+           << lama::bytecode::getInstructionName(pair.first) << ' '
+           << lama::bytecode::getInstructionName(pair.second) << '\n';
+    }
+}
+
+std::string lama::idiom::stringifyReadIdiomProfileError(lama::idiom::ReadIdiomProfileError err) {
+    std::unordered_map<lama::idiom::ReadIdiomProfileError, std::string> errorStrings = {
+        {lama::idiom::ReadIdiomProfileError::NonExistingFileError, "file does not exist"},
+        {lama::idiom::ReadIdiomProfileError::ReadFileError, "error while reading file"},
+        {lama::idiom::ReadIdiomProfileError::WrongLineFormat, "wrong line format"},
+        {lama::idiom::ReadIdiomProfileError::UnknownInstruction, "unknown instruction name"},
+        {lama::idiom::ReadIdiomProfileError::FrequencyOverflow, "total frequency is too large"},
+    };
+
+    return errorStrings[err];
+}
+
+lama::idiom::read_idiom_profile_result_t lama::idiom::readIdiomProfileFromFile(const std::string_view path) {
+    std::ifstream fis{path.data()};
+
+    if (!fis.is_open()) {
+        return lama::idiom::ReadIdiomProfileError::NonExistingFileError;
+    }
+
+    IdiomProfile profile;
+    std::uint64_t totalFreq = 0;
+    std::string line;
+
+    while (std::getline(fis, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream lineStream{line};
+
+        std::uint64_t freq;
+        std::string firstName, secondName, rest;
+
+        if (!(lineStream >> freq >> firstName >> secondName) || (lineStream >> rest)) {
+            return lama::idiom::ReadIdiomProfileError::WrongLineFormat;
+        }
+
+        const auto first = lama::bytecode::findInstructionByName(firstName);
+        const auto second = lama::bytecode::findInstructionByName(secondName);
+
+        if (!first || !second) {
+            return lama::idiom::ReadIdiomProfileError::UnknownInstruction;
+        }
+
+        if (freq > std::numeric_limits<std::uint64_t>::max() - totalFreq) {
+            return lama::idiom::ReadIdiomProfileError::FrequencyOverflow;
+        }
+
+        totalFreq += freq;
+        profile.push_back({*first, *second, freq});
+    }
+
+    if (fis.bad()) {
+        return lama::idiom::ReadIdiomProfileError::ReadFileError;
+    }
+
+    return profile;
+}
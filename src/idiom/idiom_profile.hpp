@@ -0,0 +1,54 @@
+#ifndef IDIOM_IDIOM_PROFILE_HPP
+#define IDIOM_IDIOM_PROFILE_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../bytecode/bytecode_instructions.hpp"
+#include "../bytecode/source_file.hpp"
+#include "../utils/result.hpp"
+
+/*
+ * Idiom profile is a text file which lists pairs of consecutive instructions
+ * with their frequencies regardless of the operands, the most frequent pairs go first.
+ * Each line has the following format:
+ *
+ * <frequency> <first instruction name> <second instruction name>
+ *
+ * Empty lines and lines started with '#' are ignored, the total frequency of a profile fits in 64 bits
+ */
+namespace lama::idiom {
+    struct InstructionPairFrequency {
+        lama::bytecode::InstructionOpCode first;
+        lama::bytecode::InstructionOpCode second;
+        std::uint64_t freq;
+    };
+
+    using IdiomProfile = std::vector<InstructionPairFrequency>;
+
+    IdiomProfile buildIdiomProfile(const lama::bytecode::BytecodeFile *file);
+
+    /* Same as buildIdiomProfile, but the frequencies are summed over all the files */
+    IdiomProfile buildCorpusIdiomProfile(const std::vector<const lama::bytecode::BytecodeFile *> &files);
+
+    void writeIdiomProfile(std::ostream &os, const IdiomProfile &profile);
+
+    enum class ReadIdiomProfileError {
+        NonExistingFileError = 1,
+        ReadFileError,
+        WrongLineFormat,
+        UnknownInstruction,
+        FrequencyOverflow,
+    };
+
+    std::string stringifyReadIdiomProfileError(ReadIdiomProfileError err);
+
+    using read_idiom_profile_result_t = utils::Result<IdiomProfile, ReadIdiomProfileError>;
+
+    read_idiom_profile_result_t readIdiomProfileFromFile(const std::string_view path);
+}
+
+#endif
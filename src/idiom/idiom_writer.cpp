@@ -0,0 +1,298 @@
+#include "idiom_writer.hpp"
+
+#include <charconv>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "../bytecode/decoder.hpp"
+#include "../bytecode/source_file.hpp"
+
+extern "C" {
+    int32_t disassemble_instruction(FILE *f, const lama::bytecode::bytefile_t *bf, uint32_t offset);
+}
+
+namespace {
+    constexpr std::string_view END_MARKER_NAME = "<end>";
+
+    std::string_view getPrintedName(const lama::bytecode::decoder::Instruction &instr) {
+        return instr.isEndMarker() ? END_MARKER_NAME : instr.getInfo().name;
+    }
+
+    std::string_view getOperandsHeader(lama::idiom::OperandsGrouping grouping) {
+        return grouping == lama::idiom::OperandsGrouping::CLASSES ? "classes" : "operands";
+    }
+
+    void appendJsonString(std::string &buffer, std::string_view str) {
+        constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+        buffer += '"';
+
+        for (const char c : str) {
+            if (c == '"' || c == '\\') {
+                buffer += '\\';
+                buffer += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                buffer += "\\u00";
+                buffer += HEX_DIGITS[static_cast<unsigned char>(c) >> 4];
+                buffer += HEX_DIGITS[static_cast<unsigned char>(c) & 0xf];
+            } else {
+                buffer += c;
+            }
+        }
+
+        buffer += '"';
+    }
+
+    /* Fields with separators, quotes or line breaks are quoted, quotes are doubled */
+    void appendCsvField(std::string &buffer, std::string_view field) {
+        if (field.find_first_of(",\"\r\n") == std::string_view::npos) {
+            buffer += field;
+            return;
+        }
+
+        buffer += '"';
+
+        for (const char c : field) {
+            if (c == '"') {
+                buffer += '"';
+            }
+
+            buffer += c;
+        }
+
+        buffer += '"';
+    }
+}
+
+std::optional<lama::idiom::IdiomOutputFormat> lama::idiom::parseIdiomOutputFormat(std::string_view name) {
+    if (name == "text") {
+        return IdiomOutputFormat::TEXT;
+    } else if (name == "jsonl") {
+        return IdiomOutputFormat::JSON_LINES;
+    } else if (name == "csv") {
+        return IdiomOutputFormat::CSV;
+    }
+
+    return std::nullopt;
+}
+
+lama::idiom::IdiomWriter::IdiomWriter(std::FILE *f, IdiomOutputFormat format, OperandsGrouping grouping)
+    : f_(f)
+    , format_(format)
+    , grouping_(grouping) {
+    buffer_.reserve(BUFFER_SIZE);
+
+    if (format_ == IdiomOutputFormat::CSV) {
+        buffer_ += "freq,file,offsets,opcodes,";
+        buffer_ += getOperandsHeader(grouping_);
+        buffer_ += '\n';
+    }
+}
+
+lama::idiom::IdiomWriter::~IdiomWriter() {
+    flush();
+}
+
+void lama::idiom::IdiomWriter::write(const bytecode::BytecodeFile *file, idiom_record_t span, std::uint64_t freq) {
+    switch (format_) {
+        case IdiomOutputFormat::TEXT:
+            writeText(file, span, freq);
+            return;
+        case IdiomOutputFormat::JSON_LINES:
+            writeJsonLine(file, span, freq);
+            break;
+        case IdiomOutputFormat::CSV:
+            writeCsvLine(file, span, freq);
+            break;
+    }
+
+    if (buffer_.size() >= BUFFER_SIZE) {
+        flush();
+    }
+}
+
+void lama::idiom::IdiomWriter::flush() {
+    std::fwrite(buffer_.data(), 1, buffer_.size(), f_);
+    buffer_.clear();
+}
+
+void lama::idiom::IdiomWriter::writeText(const bytecode::BytecodeFile *file, idiom_record_t span, std::uint64_t freq) {
+    // the disassembler writes to the stream directly
+    flush();
+
+    const auto [offset, instrNum] = span;
+
+    std::fprintf(f_, "%" PRIu64, freq);
+
+    if (grouping_ == OperandsGrouping::EXACT) {
+        std::uint32_t ip = offset;
+
+        for (std::size_t i = 0; i < instrNum; ++i) {
+            std::fputc('\t', f_);
+
+            const std::int32_t curInstrLen = ::disassemble_instruction(f_, file->getRawBytefile(), ip);
+            ip += curInstrLen;
+
+            std::fputs("; ", f_);
+        }
+    } else {
+        // operands are replaced with their classes, so the idiom is printed without code offsets
+        lama::bytecode::decoder::InstructionIterator instrIt{file, offset};
+
+        for (std::size_t i = 0; i < instrNum; ++i, ++instrIt) {
+            const std::string_view name = getPrintedName(*instrIt);
+            const std::string_view operandClass = stringifyOperandClass(getOperandClass(*instrIt));
+
+            std::fprintf(f_, "\t%.*s", static_cast<int>(name.size()), name.data());
+
+            if (!operandClass.empty()) {
+                std::fprintf(f_, "\t%.*s", static_cast<int>(operandClass.size()), operandClass.data());
+            }
+
+            std::fputs("; ", f_);
+        }
+    }
+
+    std::fputc('\n', f_);
+}
+
+void lama::idiom::IdiomWriter::writeJsonLine(const bytecode::BytecodeFile *file, idiom_record_t span, std::uint64_t freq) {
+    const auto [offset, instrNum] = span;
+
+    buffer_ += "{\"freq\":";
+    appendNumber(freq);
+    buffer_ += ",\"file\":";
+    appendJsonString(buffer_, file->getFilePath());
+
+    buffer_ += ",\"offsets\":[";
+
+    lama::bytecode::decoder::InstructionIterator instrIt{file, offset};
+
+    for (std::size_t i = 0; i < instrNum; ++i, ++instrIt) {
+        if (i != 0) {
+            buffer_ += ',';
+        }
+
+        appendNumber(instrIt->offset);
+    }
+
+    buffer_ += "],\"opcodes\":[";
+
+    instrIt = {file, offset};
+
+    for (std::size_t i = 0; i < instrNum; ++i, ++instrIt) {
+        if (i != 0) {
+            buffer_ += ',';
+        }
+
+        appendJsonString(buffer_, getPrintedName(*instrIt));
+    }
+
+    buffer_ += "],\"";
+    buffer_ += getOperandsHeader(grouping_);
+    buffer_ += "\":[";
+
+    instrIt = {file, offset};
+
+    for (std::size_t i = 0; i < instrNum; ++i, ++instrIt) {
+        if (i != 0) {
+            buffer_ += ',';
+        }
+
+        if (grouping_ == OperandsGrouping::CLASSES) {
+            const OperandClass operandClass = getOperandClass(*instrIt);
+
+            if (operandClass == OperandClass::NONE) {
+                buffer_ += "null";
+            } else {
+                appendJsonString(buffer_, stringifyOperandClass(operandClass));
+            }
+
+            continue;
+        }
+
+        buffer_ += '[';
+
+        for (std::size_t j = 0; j < instrIt->getInfo().operandsNumber; ++j) {
+            if (j != 0) {
+                buffer_ += ',';
+            }
+
+            appendNumber(instrIt->operands[j]);
+        }
+
+        buffer_ += ']';
+    }
+
+    buffer_ += "]}\n";
+}
+
+void lama::idiom::IdiomWriter::writeCsvLine(const bytecode::BytecodeFile *file, idiom_record_t span, std::uint64_t freq) {
+    const auto [offset, instrNum] = span;
+
+    appendNumber(freq);
+    buffer_ += ',';
+    appendCsvField(buffer_, file->getFilePath());
+    buffer_ += ',';
+
+    lama::bytecode::decoder::InstructionIterator instrIt{file, offset};
+
+    for (std::size_t i = 0; i < instrNum; ++i, ++instrIt) {
+        if (i != 0) {
+            buffer_ += ';';
+        }
+
+        appendNumber(instrIt->offset);
+    }
+
+    buffer_ += ',';
+
+    // instruction names and operands never contain separators
+    instrIt = {file, offset};
+
+    for (std::size_t i = 0; i < instrNum; ++i, ++instrIt) {
+        if (i != 0) {
+            buffer_ += ';';
+        }
+
+        buffer_ += getPrintedName(*instrIt);
+    }
+
+    buffer_ += ',';
+
+    instrIt = {file, offset};
+
+    for (std::size_t i = 0; i < instrNum; ++i, ++instrIt) {
+        if (i != 0) {
+            buffer_ += ';';
+        }
+
+        if (grouping_ == OperandsGrouping::CLASSES) {
+            buffer_ += stringifyOperandClass(getOperandClass(*instrIt));
+            continue;
+        }
+
+        for (std::size_t j = 0; j < instrIt->getInfo().operandsNumber; ++j) {
+            if (j != 0) {
+                buffer_ += ' ';
+            }
+
+            appendNumber(instrIt->operands[j]);
+        }
+    }
+
+    buffer_ += '\n';
+}
+
+template<class T>
+void lama::idiom::IdiomWriter::appendNumber(T value) {
+    char digits[24];
+    const std::to_chars_result result = std::to_chars(std::begin(digits), std::end(digits), value);
+
+    buffer_.append(digits, result.ptr);
+}
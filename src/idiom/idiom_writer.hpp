@@ -0,0 +1,70 @@
+#ifndef IDIOM_IDIOM_WRITER_HPP
+#define IDIOM_IDIOM_WRITER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "idiom_analyzer.hpp"
+
+#include "../bytecode/source_file.hpp"
+
+/*
+ * Output formats of the idiom analyzer. The text format is the disassembly of the first occurrence of an idiom
+ * (or instruction names with operand classes, if operands are grouped by classes), one idiom per line:
+ *
+ * <frequency>\t<offset>:\t<instruction>; ...
+ *
+ * Machine-readable formats have one record per idiom with the frequency, the file and the code offsets
+ * of the instructions of the first occurrence, the instruction names and their operands (or operand classes):
+ *
+ * JSON lines:
+ * {"freq":2,"file":"fib.bc","offsets":[36,41],"opcodes":["LD_A","CONST"],"operands":[[0],[2]]}
+ * {"freq":3,"file":"fib.bc","offsets":[36,41],"opcodes":["LD_A","CONST"],"classes":[null,"small"]}
+ *
+ * CSV (RFC 4180) with a header line, instructions are separated by ';' and operands of an instruction by ' ':
+ * freq,file,offsets,opcodes,operands
+ * 2,fib.bc,36;41,LD_A;CONST,0;2
+ */
+namespace lama::idiom {
+    enum class IdiomOutputFormat {
+        TEXT,
+        JSON_LINES,
+        CSV,
+    };
+
+    /* Accepts "text", "jsonl" and "csv" */
+    std::optional<IdiomOutputFormat> parseIdiomOutputFormat(std::string_view name);
+
+    /* Records are formatted into a buffer which is written to the stream when it is full and on destruction */
+    class IdiomWriter {
+    public:
+        static constexpr std::size_t BUFFER_SIZE = 64 * 1024;
+
+        IdiomWriter(std::FILE *f, IdiomOutputFormat format, OperandsGrouping grouping);
+        IdiomWriter(const IdiomWriter &) = delete;
+        IdiomWriter& operator=(const IdiomWriter &) = delete;
+        ~IdiomWriter();
+
+        void write(const bytecode::BytecodeFile *file, idiom_record_t span, std::uint64_t freq);
+
+        void flush();
+    private:
+        std::FILE *f_;
+        IdiomOutputFormat format_;
+        OperandsGrouping grouping_;
+        std::string buffer_;
+
+        void writeText(const bytecode::BytecodeFile *file, idiom_record_t span, std::uint64_t freq);
+        void writeJsonLine(const bytecode::BytecodeFile *file, idiom_record_t span, std::uint64_t freq);
+        void writeCsvLine(const bytecode::BytecodeFile *file, idiom_record_t span, std::uint64_t freq);
+
+        template<class T>
+        void appendNumber(T value);
+    };
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef INTERPRETER_EXECUTION_PROFILE_HPP
+#define INTERPRETER_EXECUTION_PROFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../bytecode/source_file.hpp"
+
+namespace lama::interpreter {
+/*
+ * Execution counts collected by the profiling dispatch loop, keyed by the code offset of an instruction.
+ * A fall-through is counted when the instruction is immediately followed by the next instruction of the code,
+ * so it is the execution count of the pair of the instruction and its successor
+ */
+class ExecutionProfile {
+public:
+    explicit ExecutionProfile(std::size_t codeSize)
+        : executions_(codeSize, 0)
+        , fallThroughs_(codeSize, 0) {
+
+    }
+
+    void countExecution(lama::bytecode::offset_t offset) {
+        ++executions_[offset];
+    }
+
+    void countFallThrough(lama::bytecode::offset_t offset) {
+        ++fallThroughs_[offset];
+    }
+
+    std::uint64_t getExecutionsCount(lama::bytecode::offset_t offset) const {
+        return executions_[offset];
+    }
+
+    std::uint64_t getFallThroughsCount(lama::bytecode::offset_t offset) const {
+        return fallThroughs_[offset];
+    }
+private:
+    std::vector<std::uint64_t> executions_;
+    std::vector<std::uint64_t> fallThroughs_;
+};
+}
+
+#endif
@@ -0,0 +1,476 @@
+#include "instruction_stream.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../bytecode/bytecode_instructions.hpp"
+#include "../bytecode/decoder.hpp"
+#include "../bytecode/source_file.hpp"
+#include "interpreter_runtime.hpp"
+#include "lama_runtime.hpp"
+
+namespace {
+    using lama::bytecode::InstructionOpCode;
+    using lama::interpreter::CapturedVariable;
+    using lama::interpreter::CaptureType;
+    using lama::interpreter::DecodedInstruction;
+    using lama::interpreter::instr_index_t;
+    using lama::interpreter::InstructionStream;
+
+    class CodeReader {
+    public:
+        CodeReader(const lama::bytecode::BytecodeFile *file, lama::bytecode::offset_t pos)
+            : file_(file)
+            , pos_(pos) {
+
+        }
+
+        lama::bytecode::offset_t getPosition() const {
+            return pos_;
+        }
+
+        std::byte readByte() {
+            return file_->getCodeByte(pos_++);
+        }
+
+        std::int32_t readInt32() {
+            std::int32_t val;
+            file_->copyCodeBytes(reinterpret_cast<std::byte *>(&val), pos_, sizeof(val));
+            pos_ += sizeof(val);
+
+            return val;
+        }
+    private:
+        const lama::bytecode::BytecodeFile *file_;
+        lama::bytecode::offset_t pos_;
+    };
+
+    lama::runtime::native_int_t getBoxedInt(std::int32_t x) {
+        const lama::interpreter::runtime::Value val{lama::runtime::native_int_t{x}};
+
+        return static_cast<lama::runtime::native_int_t>(getNativeUIntRepresentation(val.getRawWord()));
+    }
+
+    const char* findString(const lama::bytecode::BytecodeFile *file, std::int32_t index) {
+        if (index < 0 || static_cast<std::uint32_t>(index) >= file->getStringTableSize()) {
+            return nullptr;
+        }
+
+        return file->getString(index).data();
+    }
+
+    bool isTagCharacter(char c) {
+        return ('a' <= c && c <= 'z')
+               || ('A' <= c && c <= 'Z')
+               || ('0' <= c && c <= '9')
+               || c == '_'
+               || c == '\''
+               ;
+    }
+
+    /*
+     * Tags are hashed at load time unless the runtime would reject them,
+     * so that an invalid tag is reported only when its instruction is executed
+     */
+    lama::runtime::native_int_t hashTag(const char *tag) {
+        if (tag == nullptr || !std::all_of(tag, tag + std::string_view{tag}.size(), isTagCharacter)) {
+            return 0;
+        }
+
+        return ::LtagHash(const_cast<char *>(tag));
+    }
+
+    /* Returns false if the operands of the instruction exceed the code section */
+    bool decodeOperands(
+        const lama::bytecode::BytecodeFile *file,
+        const lama::interpreter::VerificationResult &verification,
+        CodeReader &reader,
+        DecodedInstruction &instr,
+        std::vector<CapturedVariable> &captures
+    ) {
+        // unknown opcodes have no operands, they are reported when executed
+        if (lama::bytecode::isValidInstruction(instr.opcode)
+            && !lama::bytecode::decoder::getInstructionLength(file, instr.offset)) {
+            return false;
+        }
+
+        switch (instr.opcode) {
+            case InstructionOpCode::CONST:
+                instr.operand0 = getBoxedInt(reader.readInt32());
+                break;
+            case InstructionOpCode::STRING:
+                instr.string = findString(file, reader.readInt32());
+                break;
+            case InstructionOpCode::SEXP:
+            case InstructionOpCode::TAG:
+                instr.string = findString(file, reader.readInt32());
+                instr.operand0 = hashTag(instr.string);
+                instr.operand1 = reader.readInt32();
+                break;
+            case InstructionOpCode::JMP:
+            case InstructionOpCode::CJMPZ:
+            case InstructionOpCode::CJMPNZ:
+            case InstructionOpCode::LD_G:
+            case InstructionOpCode::LD_L:
+            case InstructionOpCode::LD_A:
+            case InstructionOpCode::LD_C:
+            case InstructionOpCode::LDA_G:
+            case InstructionOpCode::LDA_L:
+            case InstructionOpCode::LDA_A:
+            case InstructionOpCode::LDA_C:
+            case InstructionOpCode::ST_G:
+            case InstructionOpCode::ST_L:
+            case InstructionOpCode::ST_A:
+            case InstructionOpCode::ST_C:
+            case InstructionOpCode::CALLC:
+            case InstructionOpCode::ARRAY:
+            case InstructionOpCode::LINE:
+            case InstructionOpCode::CALL_BARRAY:
+                instr.operand0 = reader.readInt32();
+                break;
+            case InstructionOpCode::BEGIN:
+            case InstructionOpCode::CBEGIN: {
+                instr.operand0 = reader.readInt32();
+                instr.operand1 = reader.readInt32();
+
+                // the frame stack size is computed by the static verifier, see BytecodeVerifier::saveFrameInfo
+                instr.operand2 = verification.getFrameStackSize(instr.offset);
+                break;
+            }
+            case InstructionOpCode::CLOSURE: {
+                instr.operand0 = reader.readInt32();
+                instr.operand1 = reader.readInt32();
+
+                for (std::int32_t i = 0; i < instr.operand1; ++i) {
+                    const CaptureType type{std::to_integer<unsigned char>(reader.readByte())};
+                    captures.push_back({type, reader.readInt32()});
+                }
+
+                break;
+            }
+            case InstructionOpCode::CALL:
+            case InstructionOpCode::FAIL:
+                instr.operand0 = reader.readInt32();
+                instr.operand1 = reader.readInt32();
+                break;
+            default:
+                break;
+        }
+
+        return true;
+    }
+
+    instr_index_t appendInvalidJump(
+        std::vector<DecodedInstruction> &instructions,
+        lama::bytecode::offset_t offset,
+        lama::runtime::native_int_t target
+    ) {
+        DecodedInstruction instr{};
+        instr.opcode = lama::interpreter::pseudo_opcode::INVALID_JUMP;
+        instr.offset = offset;
+        instr.operand0 = target;
+
+        instructions.push_back(instr);
+
+        return instructions.size() - 1;
+    }
+
+    /* Returns the opcode itself if the instruction has no quickened form */
+    InstructionOpCode getQuickenedOpcode(InstructionOpCode opcode) {
+        switch (opcode) {
+            case InstructionOpCode::BINOP_ADD:
+            case InstructionOpCode::BINOP_SUB:
+            case InstructionOpCode::BINOP_MUL:
+            case InstructionOpCode::BINOP_DIV:
+            case InstructionOpCode::BINOP_MOD:
+            case InstructionOpCode::BINOP_LT:
+            case InstructionOpCode::BINOP_LE:
+            case InstructionOpCode::BINOP_GT:
+            case InstructionOpCode::BINOP_GE:
+            case InstructionOpCode::BINOP_EQ:
+            case InstructionOpCode::BINOP_NE:
+            case InstructionOpCode::BINOP_AND:
+            case InstructionOpCode::BINOP_OR:
+                return InstructionOpCode{static_cast<unsigned char>(
+                    static_cast<unsigned char>(opcode) | lama::interpreter::quick_opcode::BINOP_BITS
+                )};
+            case InstructionOpCode::CJMPZ:
+                return lama::interpreter::quick_opcode::CJMPZ;
+            case InstructionOpCode::CJMPNZ:
+                return lama::interpreter::quick_opcode::CJMPNZ;
+            default:
+                return opcode;
+        }
+    }
+
+    /* Returns the opcode itself if it is not quickened */
+    InstructionOpCode getUnquickenedOpcode(InstructionOpCode opcode) {
+        if (opcode == lama::interpreter::quick_opcode::CJMPZ) {
+            return InstructionOpCode::CJMPZ;
+        } else if (opcode == lama::interpreter::quick_opcode::CJMPNZ) {
+            return InstructionOpCode::CJMPNZ;
+        }
+
+        const InstructionOpCode binop = lama::interpreter::quick_opcode::getBinopOpcode(opcode);
+
+        return getQuickenedOpcode(binop) == opcode ? binop : opcode;
+    }
+
+    bool isFunctionBegin(InstructionOpCode opcode) {
+        return opcode == InstructionOpCode::BEGIN || opcode == InstructionOpCode::CBEGIN;
+    }
+
+    bool isUnverifiedFunctionBegin(InstructionOpCode opcode) {
+        return opcode == lama::interpreter::pseudo_opcode::UNVERIFIED_BEGIN
+               || opcode == lama::interpreter::pseudo_opcode::UNVERIFIED_CBEGIN
+               ;
+    }
+
+    bool takesFrameAddress(const DecodedInstruction &instr) {
+        return instr.opcode == InstructionOpCode::LDA_L || instr.opcode == InstructionOpCode::LDA_A;
+    }
+
+    /*
+     * A tail call discards the frame of the caller, so calls are not replaced in functions
+     * which take addresses of their locals or arguments: the callee could store through them
+     */
+    void replaceTailCalls(std::vector<DecodedInstruction> &instructions, std::size_t begin, std::size_t end) {
+        if (std::any_of(instructions.begin() + begin, instructions.begin() + end, takesFrameAddress)) {
+            return;
+        }
+
+        for (std::size_t i = begin; i + 1 < end; ++i) {
+            if (instructions[i + 1].opcode != InstructionOpCode::END) {
+                continue;
+            }
+
+            if (instructions[i].opcode == InstructionOpCode::CALL) {
+                instructions[i].opcode = lama::interpreter::pseudo_opcode::TAIL_CALL;
+            } else if (instructions[i].opcode == InstructionOpCode::CALLC) {
+                instructions[i].opcode = lama::interpreter::pseudo_opcode::TAIL_CALLC;
+            }
+        }
+    }
+}
+
+lama::interpreter::InstructionStream::InstructionStream(
+    std::vector<DecodedInstruction>&& instructions,
+    std::vector<CapturedVariable>&& captures,
+    std::vector<instr_index_t>&& indices,
+    instr_index_t entryPointIndex,
+    std::size_t callSitesNumber
+)
+    : instructions_(std::move(instructions))
+    , captures_(std::move(captures))
+    , indices_(std::move(indices))
+    , entryPointIndex_(entryPointIndex)
+    , callSitesNumber_(callSitesNumber) {
+
+}
+
+void lama::interpreter::InstructionStream::setFrameStackSize(
+    lama::bytecode::offset_t functionBegin,
+    std::uint32_t frameStackSize
+) {
+    DecodedInstruction *instr = findInstruction(functionBegin);
+
+    // the entry point is verified as a function even if it does not start with BEGIN
+    if (instr != nullptr && isUnverifiedFunctionBegin(instr->opcode)) {
+        instr->operand2 = frameStackSize;
+    }
+}
+
+void lama::interpreter::InstructionStream::setIntOperands(lama::bytecode::offset_t offset, bool proven) {
+    DecodedInstruction *instr = findInstruction(offset);
+
+    if (instr == nullptr) {
+        return;
+    }
+
+    // the facts of a function sharing the code with the verified ones may disprove them
+    const InstructionOpCode original = getUnquickenedOpcode(instr->opcode);
+    const InstructionOpCode quickened = getQuickenedOpcode(original);
+
+    // superinstructions are not quickened
+    if (quickened != original) {
+        instr->opcode = proven ? quickened : original;
+    }
+}
+
+void lama::interpreter::InstructionStream::setStoreDestination(
+    lama::bytecode::offset_t offset,
+    StoreDestination destination
+) {
+    DecodedInstruction *instr = findInstruction(offset);
+
+    if (instr != nullptr && instr->opcode == InstructionOpCode::STA) {
+        instr->operand0 = static_cast<lama::runtime::native_int_t>(destination);
+    }
+}
+
+void lama::interpreter::InstructionStream::markFunctionVerified(lama::bytecode::offset_t functionBegin) {
+    DecodedInstruction *instr = findInstruction(functionBegin);
+
+    if (instr == nullptr) {
+        return;
+    }
+
+    if (instr->opcode == pseudo_opcode::UNVERIFIED_BEGIN) {
+        instr->opcode = InstructionOpCode::BEGIN;
+    } else if (instr->opcode == pseudo_opcode::UNVERIFIED_CBEGIN) {
+        instr->opcode = InstructionOpCode::CBEGIN;
+    }
+}
+
+lama::interpreter::InstructionStream lama::interpreter::decodeBytecodeFile(
+    const lama::bytecode::BytecodeFile *file,
+    const SuperinstructionSet &superinstructions,
+    const VerificationResult &verification,
+    bool lazyVerification
+) {
+    const TypeFacts &typeFacts = verification.getTypeFacts();
+    const std::size_t codeSize = file->getCodeSize();
+
+    std::vector<DecodedInstruction> instructions;
+    std::vector<CapturedVariable> captures;
+    std::vector<std::size_t> capturesStarts;
+    std::vector<instr_index_t> indices(codeSize, InstructionStream::NO_INDEX);
+
+    instructions.reserve(codeSize / 2);
+
+    lama::bytecode::offset_t offset = 0;
+
+    /*
+     * Lama bytecode has no data between instructions, so a linear sweep decodes all of them.
+     * Unknown opcodes are kept as is to be reported when executed, decoding continues
+     * from the next byte
+     */
+    while (offset < codeSize) {
+        DecodedInstruction instr{};
+        instr.opcode = file->getInstruction(offset);
+        instr.offset = offset;
+
+        CodeReader reader{file, offset + 1};
+        const std::size_t capturesStart = captures.size();
+
+        if (!decodeOperands(file, verification, reader, instr, captures)) {
+            captures.resize(capturesStart);
+            break;
+        }
+
+        indices[offset] = instructions.size();
+        instructions.push_back(instr);
+        capturesStarts.push_back(capturesStart);
+
+        offset = reader.getPosition();
+    }
+
+    DecodedInstruction endOfCode{};
+    endOfCode.opcode = pseudo_opcode::END_OF_CODE;
+    endOfCode.offset = offset;
+    instructions.push_back(endOfCode);
+
+    const std::size_t decodedNumber = capturesStarts.size();
+    std::size_t callSitesNumber = 0;
+
+    for (std::size_t i = 0; i < decodedNumber; ++i) {
+        DecodedInstruction &instr = instructions[i];
+
+        if (instr.opcode == InstructionOpCode::CLOSURE) {
+            instr.captures = captures.data() + capturesStarts[i];
+        } else if (instr.opcode == InstructionOpCode::CALLC) {
+            instr.operand1 = callSitesNumber++;
+        } else if (lama::bytecode::getInstructionInfo(instr.opcode).isBranch) {
+            const lama::runtime::native_int_t target = instr.operand0;
+
+            instr_index_t targetIndex = target >= 0 && static_cast<std::size_t>(target) < codeSize
+                ? indices[target]
+                : InstructionStream::NO_INDEX;
+
+            if (targetIndex == InstructionStream::NO_INDEX) {
+                targetIndex = appendInvalidJump(instructions, instr.offset, target);
+            }
+
+            // instructions might have been reallocated
+            instructions[i].operand0 = targetIndex;
+        }
+    }
+
+    /*
+     * Fusion is performed after jump targets resolution, since it replaces opcodes.
+     * Pairs do not overlap, the second instruction of a pair is never fused with the next one
+     */
+    if (!superinstructions.empty()) {
+        for (std::size_t i = 0; i + 1 < decodedNumber; ++i) {
+            DecodedInstruction &instr = instructions[i];
+            const InstructionOpCode fused = superinstructions.getFusedOpcode(instr.opcode, instructions[i + 1].opcode);
+
+            if (fused != instr.opcode) {
+                instr.opcode = fused;
+                ++i;
+            }
+        }
+    }
+
+    /*
+     * Quickening is performed after fusion, so superinstructions are matched by the original opcodes.
+     * The second instruction of a pair is still quickened, since it is executed on jumps into the pair
+     */
+    for (std::size_t i = 0; i < decodedNumber; ++i) {
+        DecodedInstruction &instr = instructions[i];
+
+        if (typeFacts.hasIntOperands(instr.offset)) {
+            instr.opcode = getQuickenedOpcode(instr.opcode);
+        }
+
+        // the arity of a verified STA is fixed by the verifier and must not be chosen at runtime
+        if (instr.opcode == InstructionOpCode::STA) {
+            instr.operand0 = static_cast<lama::runtime::native_int_t>(typeFacts.getStoreDestination(instr.offset));
+        }
+    }
+
+    /* Functions are delimited by BEGIN and CBEGIN in the order of the code section */
+    for (std::size_t begin = 0; begin < decodedNumber;) {
+        std::size_t end = begin + 1;
+
+        while (end < decodedNumber && !isFunctionBegin(instructions[end].opcode)) {
+            ++end;
+        }
+
+        replaceTailCalls(instructions, begin, end);
+        begin = end;
+    }
+
+    if (lazyVerification) {
+        for (std::size_t i = 0; i < decodedNumber; ++i) {
+            DecodedInstruction &instr = instructions[i];
+
+            if (instr.opcode == InstructionOpCode::BEGIN) {
+                instr.opcode = pseudo_opcode::UNVERIFIED_BEGIN;
+            } else if (instr.opcode == InstructionOpCode::CBEGIN) {
+                instr.opcode = pseudo_opcode::UNVERIFIED_CBEGIN;
+            }
+        }
+    }
+
+    const std::int32_t entryPoint = file->getEntryPointOffset();
+    instr_index_t entryPointIndex = entryPoint >= 0 && static_cast<std::size_t>(entryPoint) < codeSize
+        ? indices[entryPoint]
+        : InstructionStream::NO_INDEX;
+
+    if (entryPointIndex == InstructionStream::NO_INDEX) {
+        entryPointIndex = appendInvalidJump(instructions, entryPoint, entryPoint);
+    }
+
+    return InstructionStream{
+        std::move(instructions),
+        std::move(captures),
+        std::move(indices),
+        entryPointIndex,
+        callSitesNumber
+    };
+}
@@ -0,0 +1,203 @@
+#ifndef INTERPRETER_INSTRUCTION_STREAM_HPP
+#define INTERPRETER_INSTRUCTION_STREAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../bytecode/bytecode_instructions.hpp"
+#include "../bytecode/source_file.hpp"
+
+#include "lama_runtime.hpp"
+#include "superinstructions.hpp"
+#include "type_facts.hpp"
+#include "verification_result.hpp"
+
+namespace lama::interpreter {
+using instr_index_t = std::uint32_t;
+
+enum class CaptureType : unsigned char {
+    GLOBAL = 0x0,
+    LOCAL = 0x1,
+    ARGUMENT = 0x2,
+    CAPTURE = 0x3,
+};
+
+struct CapturedVariable {
+    CaptureType type;
+    std::int32_t index;
+};
+
+/*
+ * Pseudo instructions are produced by the decoder only, they use opcodes
+ * that are not occupied by the bytecode format
+ */
+namespace pseudo_opcode {
+    /* Replaces the target of a jump or a call which does not point to the beginning of an instruction */
+    constexpr lama::bytecode::InstructionOpCode INVALID_JUMP = lama::bytecode::InstructionOpCode::PSEUDO_INVALID_JUMP;
+
+    /* Terminates the instruction stream, execution must not fall through the end of code */
+    constexpr lama::bytecode::InstructionOpCode END_OF_CODE = lama::bytecode::InstructionOpCode::PSEUDO_END_OF_CODE;
+
+    /*
+     * Replace CALL and CALLC immediately followed by END, the callee reuses the frame of the caller
+     * and returns directly to its caller. The END record stays intact for jumps into it
+     */
+    constexpr lama::bytecode::InstructionOpCode TAIL_CALL = lama::bytecode::InstructionOpCode::PSEUDO_TAIL_CALL;
+    constexpr lama::bytecode::InstructionOpCode TAIL_CALLC = lama::bytecode::InstructionOpCode::PSEUDO_TAIL_CALLC;
+
+    /*
+     * Replace BEGIN and CBEGIN of functions which have not been verified yet when verification is lazy,
+     * the function is verified on its first entry and the original opcode is restored
+     */
+    constexpr lama::bytecode::InstructionOpCode UNVERIFIED_BEGIN = lama::bytecode::InstructionOpCode::PSEUDO_UNVERIFIED_BEGIN;
+    constexpr lama::bytecode::InstructionOpCode UNVERIFIED_CBEGIN = lama::bytecode::InstructionOpCode::PSEUDO_UNVERIFIED_CBEGIN;
+}
+
+/*
+ * Quickened instructions replace instructions whose operands are proven to be integers
+ * by the static verifier, their handlers do not check the operand tags.
+ * A quickened binop opcode is the binop opcode with the 0xc0 bits set
+ */
+namespace quick_opcode {
+    constexpr unsigned char BINOP_BITS = 0xc0;
+
+    constexpr lama::bytecode::InstructionOpCode BINOP_ADD = lama::bytecode::InstructionOpCode::QUICK_BINOP_ADD;
+    constexpr lama::bytecode::InstructionOpCode BINOP_SUB = lama::bytecode::InstructionOpCode::QUICK_BINOP_SUB;
+    constexpr lama::bytecode::InstructionOpCode BINOP_MUL = lama::bytecode::InstructionOpCode::QUICK_BINOP_MUL;
+    constexpr lama::bytecode::InstructionOpCode BINOP_DIV = lama::bytecode::InstructionOpCode::QUICK_BINOP_DIV;
+    constexpr lama::bytecode::InstructionOpCode BINOP_MOD = lama::bytecode::InstructionOpCode::QUICK_BINOP_MOD;
+    constexpr lama::bytecode::InstructionOpCode BINOP_LT = lama::bytecode::InstructionOpCode::QUICK_BINOP_LT;
+    constexpr lama::bytecode::InstructionOpCode BINOP_LE = lama::bytecode::InstructionOpCode::QUICK_BINOP_LE;
+    constexpr lama::bytecode::InstructionOpCode BINOP_GT = lama::bytecode::InstructionOpCode::QUICK_BINOP_GT;
+    constexpr lama::bytecode::InstructionOpCode BINOP_GE = lama::bytecode::InstructionOpCode::QUICK_BINOP_GE;
+    constexpr lama::bytecode::InstructionOpCode BINOP_EQ = lama::bytecode::InstructionOpCode::QUICK_BINOP_EQ;
+    constexpr lama::bytecode::InstructionOpCode BINOP_NE = lama::bytecode::InstructionOpCode::QUICK_BINOP_NE;
+    constexpr lama::bytecode::InstructionOpCode BINOP_AND = lama::bytecode::InstructionOpCode::QUICK_BINOP_AND;
+    constexpr lama::bytecode::InstructionOpCode BINOP_OR = lama::bytecode::InstructionOpCode::QUICK_BINOP_OR;
+
+    constexpr lama::bytecode::InstructionOpCode CJMPZ = lama::bytecode::InstructionOpCode::QUICK_CJMPZ;
+    constexpr lama::bytecode::InstructionOpCode CJMPNZ = lama::bytecode::InstructionOpCode::QUICK_CJMPNZ;
+
+    /* Maps a quickened binop to the original one */
+    constexpr lama::bytecode::InstructionOpCode getBinopOpcode(lama::bytecode::InstructionOpCode op) {
+        return lama::bytecode::InstructionOpCode{static_cast<unsigned char>(static_cast<unsigned char>(op) & ~BINOP_BITS)};
+    }
+}
+
+/*
+
+Operands of decoded instructions:
+
+Instruction      | operand0                  | operand1            | payload
+:----------------|:--------------------------|:--------------------|:--------------------------
+CONST            | boxed constant            |                     |
+STRING           |                           |                     | string
+SEXP, TAG        | boxed tag hash            | members number      | string (tag)
+JMP, CJMPZ/NZ    | target index              |                     |
+LD, LDA, ST      | variable index            |                     |
+BEGIN, CBEGIN    | arguments number          | locals number       | operand2 (frame stack size, 0 if unverified)
+UNVERIFIED_BEGIN | arguments number          | locals number       | operand2 (0)
+UNVERIFIED_CBEGIN| arguments number          | locals number       | operand2 (0)
+CLOSURE          | target code offset        | captures number     | captures
+CALLC, TAIL_CALLC| arguments number          | call site index     |
+CALL, TAIL_CALL  | target index              | arguments number    |
+STA              | store destination         |                     |
+ARRAY            | elements number           |                     |
+FAIL             | line number               | column number       |
+LINE             | line number               |                     |
+CALL_BARRAY      | elements number           |                     |
+INVALID_JUMP     | invalid target offset     |                     |
+
+String pointers are null if string table index is out of range, tag hash is zero if it cannot be
+computed at load time.
+
+*/
+struct alignas(32) DecodedInstruction {
+    lama::bytecode::InstructionOpCode opcode;
+    lama::bytecode::offset_t offset;
+    lama::runtime::native_int_t operand0;
+    lama::runtime::native_int_t operand1;
+
+    union {
+        const char *string;
+        const CapturedVariable *captures;
+        lama::runtime::native_int_t operand2;
+    };
+};
+
+class InstructionStream {
+public:
+    static constexpr instr_index_t NO_INDEX = ~instr_index_t{0};
+
+    InstructionStream(
+        std::vector<DecodedInstruction>&& instructions,
+        std::vector<CapturedVariable>&& captures,
+        std::vector<instr_index_t>&& indices,
+        instr_index_t entryPointIndex,
+        std::size_t callSitesNumber
+    );
+    InstructionStream(const InstructionStream &other) = delete;
+    InstructionStream(InstructionStream&& other) = default;
+    ~InstructionStream() = default;
+
+    const DecodedInstruction& operator[](instr_index_t i) const {
+        return instructions_[i];
+    }
+
+    std::size_t size() const {
+        return instructions_.size();
+    }
+
+    /* Returns NO_INDEX if there is no instruction starting at the given offset */
+    instr_index_t getInstructionIndex(lama::bytecode::offset_t offset) const {
+        return offset < indices_.size() ? indices_[offset] : NO_INDEX;
+    }
+
+    instr_index_t getEntryPointIndex() const {
+        return entryPointIndex_;
+    }
+
+    /* Number of CALLC instructions, each of them has its own call site index */
+    std::size_t getCallSitesNumber() const {
+        return callSitesNumber_;
+    }
+
+    /*
+     * A lazily verified function is patched with the facts proven by the verifier before its first entry.
+     * Offsets which are not the beginnings of suitable instructions are ignored
+     */
+    void setFrameStackSize(lama::bytecode::offset_t functionBegin, std::uint32_t frameStackSize);
+    void setIntOperands(lama::bytecode::offset_t offset, bool proven);
+    void setStoreDestination(lama::bytecode::offset_t offset, StoreDestination destination);
+
+    /* Restores BEGIN or CBEGIN of a lazily verified function, the other instructions are not changed */
+    void markFunctionVerified(lama::bytecode::offset_t functionBegin);
+private:
+    std::vector<DecodedInstruction> instructions_;
+    std::vector<CapturedVariable> captures_;
+    std::vector<instr_index_t> indices_;
+    instr_index_t entryPointIndex_;
+    std::size_t callSitesNumber_;
+
+    DecodedInstruction* findInstruction(lama::bytecode::offset_t offset) {
+        const instr_index_t index = getInstructionIndex(offset);
+
+        return index != NO_INDEX ? &instructions_[index] : nullptr;
+    }
+};
+
+/*
+ * Pairs of consecutive instructions from the given set are fused into superinstructions,
+ * instructions with operands proven to be integers are quickened, calls in tail position
+ * are replaced with tail calls. With lazy verification all the functions are marked as unverified
+ */
+InstructionStream decodeBytecodeFile(
+    const lama::bytecode::BytecodeFile *file,
+    const SuperinstructionSet &superinstructions = SuperinstructionSet{},
+    const VerificationResult &verification = VerificationResult{},
+    bool lazyVerification = false
+);
+}
+
+#endif
@@ -1,7 +1,14 @@
 #include "interpreter.hpp"
+#include "lazy_verifier.hpp"
 #include "verifier.hpp"
+#include "verification_cache.hpp"
 
+#include "../jit/template_jit.hpp"
+
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <iterator>
 
 #ifdef INTERPRETER_DEBUG
 #include <iostream>
@@ -13,6 +20,20 @@
 
 #include "interpreter_runtime.hpp"
 
+#ifdef INTERPRETER_DEBUG
+namespace {
+    const char *getBinopString(lama::bytecode::InstructionOpCode opcode) {
+        static const char * const opStrings[] = {
+            "+", "-", "*", "/", "%",
+            "<", "<=", ">", ">=", "==", "!=",
+            "&&", "!!",
+        };
+
+        return opStrings[static_cast<unsigned int>(opcode) - 0x1];
+    }
+}
+#endif
+
 /* CallStack implementation */
 
 lama::interpreter::utils::CallStack::CallStack(std::size_t initialSize)
@@ -54,24 +75,12 @@ const lama::runtime::Word* lama::interpreter::CallstackFrame::getArgumentsStartA
     return getFrameBase() - getArgumentsCount();
 }
 
-lama::runtime::Word* lama::interpreter::CallstackFrame::getCapturedContentAddress() {
-    return reinterpret_cast<lama::runtime::Word *>(*(getArgumentsStartAddress() - 1));
-}
-
 const lama::runtime::Word* lama::interpreter::CallstackFrame::getCapturedContentAddress() const {
     return reinterpret_cast<lama::runtime::Word *>(*(getArgumentsStartAddress() - 1));
 }
 
-lama::runtime::Word* lama::interpreter::CallstackFrame::getCapturedValueAddress(lama::bytecode::offset_t i) {
-    return getCapturedContentAddress() + i + 1;
-}
-
-const lama::runtime::Word* lama::interpreter::CallstackFrame::getCapturedValueAddress(lama::bytecode::offset_t i) const {
-    return getCapturedContentAddress() + i + 1;
-}
-
 std::uint32_t lama::interpreter::CallstackFrame::getCapturesCount() const {
-    void *closureDataPtr = TO_DATA(getCapturedContentAddress());
+    void *closureDataPtr = TO_DATA(const_cast<lama::runtime::Word *>(getCapturedContentAddress()));
 
     return ::get_len(static_cast<data *>(closureDataPtr)) - 1;
 }
@@ -106,13 +115,6 @@ lama::runtime::native_uint_t getBoxedStringViewAsUint(std::string_view sv) {
 
     return getBoxedUIntAsUInt(ptrval);
 }
-
-enum class CaptureType : unsigned char {
-    GLOBAL = 0x0,
-    LOCAL = 0x1,
-    ARGUMENT = 0x2,
-    CAPTURE = 0x3,
-};
 }
 
 #ifdef INTERPRETER_DEBUG
@@ -122,33 +124,41 @@ enum class CaptureType : unsigned char {
 #endif
 
 #define DO_IF_DYN_VER(X) do {\
-    if (mode_ == VerificationMode::DYNAMIC_VERIFICATION) {\
+    if constexpr (DYNAMIC_CHECKS) {\
          (X);\
     }\
  } while (0)
 
-lama::interpreter::BytecodeInterpreterState::BytecodeInterpreterState(
+template<lama::interpreter::VerificationMode Mode>
+lama::interpreter::BytecodeInterpreterState<Mode>::BytecodeInterpreterState(
     const lama::bytecode::BytecodeFile *bytecodeFile,
-    VerificationMode mode
+    const InstructionStream *code,
+    lama::verifier::LazyVerifier *lazyVerifier
 )
     : gcInitialized_(false)
-    , ip_(bytecodeFile->getEntryPointOffset())
-    , instructionStartOffset_(0)
-    , mode_(mode)
+    , ip_(code->getEntryPointIndex())
+    , currentInstruction_(&(*code)[code->getEntryPointIndex()])
     , stack_(dataStackBuffer, bytecodeFile->getGlobalAreaSize() + lama::runtime::MAIN_FUNCTION_ARGUMENTS)
     , callstack_()
     , isClosureCalled_(false)
     , endReached_(false)
-    , bytecodeFile_(bytecodeFile) {
+    , bytecodeFile_(bytecodeFile)
+    , code_(code)
+    , instructions_(&(*code)[0])
+    , callSiteCaches_(code->getCallSitesNumber())
+    , lazyVerifier_(lazyVerifier)
+    , localsBase_(nullptr)
+    , argumentsBase_(nullptr) {
     pushValue(lama::runtime::native_uint_t{0});
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeArithBinop(lama::bytecode::InstructionOpCode opcode) {
+template<lama::interpreter::VerificationMode Mode>
+lama::runtime::native_int_t lama::interpreter::BytecodeInterpreterState<Mode>::computeArithBinop(
+    lama::bytecode::InstructionOpCode opcode,
+    lama::runtime::native_int_t x,
+    lama::runtime::native_int_t y
+) const {
     using lama::bytecode::InstructionOpCode;
-    using lama::interpreter::runtime::LamaTag;
-
-    const lama::runtime::native_int_t y = popIntValue().getNativeInt();
-    const lama::runtime::native_int_t x = popIntValue().getNativeInt();
 
     lama::runtime::native_int_t result;
 
@@ -174,10 +184,90 @@ void lama::interpreter::BytecodeInterpreterState::executeArithBinop(lama::byteco
             break;
     }
 
-    pushValue(result);
+    return result;
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeComparisonBinop(lama::bytecode::InstructionOpCode opcode) {
+template<lama::interpreter::VerificationMode Mode>
+bool lama::interpreter::BytecodeInterpreterState<Mode>::computeComparisonBinop(
+    lama::bytecode::InstructionOpCode opcode,
+    lama::runtime::native_int_t x,
+    lama::runtime::native_int_t y
+) const {
+    using lama::bytecode::InstructionOpCode;
+
+    bool flag = false;
+
+    switch (opcode) {
+        case InstructionOpCode::BINOP_LT:
+            flag = x < y;
+            break;
+        case InstructionOpCode::BINOP_LE:
+            flag = x <= y;
+            break;
+        case InstructionOpCode::BINOP_GT:
+            flag = x > y;
+            break;
+        case InstructionOpCode::BINOP_GE:
+            flag = x >= y;
+            break;
+        case InstructionOpCode::BINOP_EQ:
+            flag = x == y;
+            break;
+        case InstructionOpCode::BINOP_NE:
+            flag = x != y;
+            break;
+        default:
+            break;
+    }
+
+    return flag;
+}
+
+template<lama::interpreter::VerificationMode Mode>
+bool lama::interpreter::BytecodeInterpreterState<Mode>::computeEquality(
+    lama::interpreter::runtime::Value value0,
+    lama::interpreter::runtime::Value value1
+) const {
+    interpreterAssert(value0.isInt() || value1.isInt(), "at least one of equality operands must be an integer");
+
+    return value0.isInt() && value1.isInt() && (value0.getNativeInt() == value1.getNativeInt());
+}
+
+template<lama::interpreter::VerificationMode Mode>
+lama::runtime::Word lama::interpreter::BytecodeInterpreterState<Mode>::computeIntBinop(
+    lama::bytecode::InstructionOpCode opcode,
+    lama::runtime::native_int_t x,
+    lama::runtime::native_int_t y
+) const {
+    using lama::bytecode::InstructionOpCode;
+    using lama::interpreter::runtime::Value;
+
+    switch (opcode) {
+        case InstructionOpCode::BINOP_ADD:
+        case InstructionOpCode::BINOP_SUB:
+        case InstructionOpCode::BINOP_MUL:
+        case InstructionOpCode::BINOP_DIV:
+        case InstructionOpCode::BINOP_MOD:
+            return Value{computeArithBinop(opcode, x, y)}.getRawWord();
+        case InstructionOpCode::BINOP_AND:
+            return Value{static_cast<bool>(x && y)}.getRawWord();
+        case InstructionOpCode::BINOP_OR:
+            return Value{static_cast<bool>(x || y)}.getRawWord();
+        default:
+            return Value{computeComparisonBinop(opcode, x, y)}.getRawWord();
+    }
+}
+
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeArithBinop(lama::bytecode::InstructionOpCode opcode) {
+    const lama::runtime::native_int_t y = popIntValue().getNativeInt();
+    const lama::runtime::native_int_t x = popIntValue().getNativeInt();
+
+    pushValue(computeArithBinop(opcode, x, y));
+}
+
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeComparisonBinop(lama::bytecode::InstructionOpCode opcode) {
     using lama::bytecode::InstructionOpCode;
 
     bool flag = false;
@@ -186,38 +276,19 @@ void lama::interpreter::BytecodeInterpreterState::executeComparisonBinop(lama::b
         const lama::interpreter::runtime::Value value1 = popValue();
         const lama::interpreter::runtime::Value value0 = popValue();
 
-        interpreterAssert(value0.isInt() || value1.isInt(), "at least one of equality operands must be an integer");
-
-        flag = value0.isInt() && value1.isInt() && (value0.getNativeInt() == value1.getNativeInt());
+        flag = computeEquality(value0, value1);
     } else {
         const lama::runtime::native_int_t y = popIntValue().getNativeInt();
         const lama::runtime::native_int_t x = popIntValue().getNativeInt();
 
-        switch (opcode) {
-            case InstructionOpCode::BINOP_LT:
-                flag = x < y;
-                break;
-            case InstructionOpCode::BINOP_LE:
-                flag = x <= y;
-                break;
-            case InstructionOpCode::BINOP_GT:
-                flag = x > y;
-                break;
-            case InstructionOpCode::BINOP_GE:
-                flag = x >= y;
-                break;
-            case InstructionOpCode::BINOP_NE:
-                flag = x != y;
-                break;
-            default:
-                break;
-        }
+        flag = computeComparisonBinop(opcode, x, y);
     }
 
     pushValue(flag);
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeLogicalBinop(lama::bytecode::InstructionOpCode opcode) {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeLogicalBinop(lama::bytecode::InstructionOpCode opcode) {
     using lama::bytecode::InstructionOpCode;
 
     const lama::runtime::native_int_t y = popIntValue().getNativeInt();
@@ -230,7 +301,8 @@ void lama::interpreter::BytecodeInterpreterState::executeLogicalBinop(lama::byte
     ));
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeBinop(lama::bytecode::InstructionOpCode opcode) {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeBinop(lama::bytecode::InstructionOpCode opcode) {
     using lama::bytecode::InstructionOpCode;
 
     switch (opcode) {
@@ -257,28 +329,30 @@ void lama::interpreter::BytecodeInterpreterState::executeBinop(lama::bytecode::I
             break;
     }
 
-    #ifdef INTERPRETER_DEBUG
-    static const char * const opStrings[] = {
-        "+", "-", "*", "/", "%",
-        "<", "<=", ">", ">=", "==", "!=",
-        "&&", "!!",
-    };
-
-    DO_IF_DEBUG(std::cout << "BINOP\t" << opStrings[static_cast<unsigned int>(opcode) - 0x1] << '\n');
-    #endif
+    DO_IF_DEBUG(std::cout << "BINOP\t" << getBinopString(opcode) << '\n');
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeConst() {
-    const std::int32_t constVal = fetchInt32();
+/* Operands of quickened binops are proven to be integers by the static verifier */
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeIntBinop(lama::bytecode::InstructionOpCode opcode) {
+    const lama::runtime::native_int_t y = popValue().getNativeInt();
+    const lama::runtime::native_int_t x = popValue().getNativeInt();
 
-    pushValue(lama::runtime::native_int_t{constVal});
+    pushWord(computeIntBinop(opcode, x, y));
 
-    DO_IF_DEBUG(std::cout << "CONST\t" << constVal << '\n');
+    DO_IF_DEBUG(std::cout << "BINOP\t" << getBinopString(opcode) << '\n');
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeString() {
-    const std::int32_t strPos = fetchInt32();
-    std::string_view strview = getString(strPos);
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeConst(const DecodedInstruction &instr) {
+    pushWord(lama::runtime::Word(instr.operand0));
+
+    DO_IF_DEBUG(std::cout << "CONST\t" << UNBOX(instr.operand0) << '\n');
+}
+
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeString(const DecodedInstruction &instr) {
+    std::string_view strview = getString(instr);
     const void * strTableEntity = strview.data();
     const void * const str = Bstring(reinterpret_cast<aint *>(&(strTableEntity)));
 
@@ -287,26 +361,34 @@ void lama::interpreter::BytecodeInterpreterState::executeString() {
     DO_IF_DEBUG(std::cout << "STRING\t\"" << strview << "\"\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeSexp() {
-    const std::int32_t sexpTagPos = fetchInt32();
-    std::string_view sexpTagStr = getString(sexpTagPos);
-    const lama::runtime::native_uint_t tagHash = ::LtagHash(const_cast<char *>(sexpTagStr.data()));
-    pushWord(lama::runtime::Word{tagHash});
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeSexp(const DecodedInstruction &instr) {
+    const lama::runtime::native_uint_t tagHash = getTagHash(instr);
 
-    const std::int32_t n = fetchInt32();
+    const std::int32_t n = instr.operand1;
     DO_IF_DYN_VER(checkNonNegative(n, "sexp members count must not be negative"));
-    lama::runtime::native_int_t *arrayPtr = reinterpret_cast<lama::runtime::native_int_t *>(peekWordAddress(n + 1));;
 
-    lama::runtime::native_uint_t boxedMembers = getBoxedIntAsUInt(n + 1);
-    lama::runtime::Word sexpPtr{reinterpret_cast<lama::runtime::native_uint_t>(::Bsexp(arrayPtr, boxedMembers))};
+    if (void *sexpPtr = lama::interpreter::runtime::tryAllocateSexp(peekWordAddress(n), n, UNBOX(tagHash))) {
+        popWords(n);
+        pushValue(sexpPtr);
+    } else {
+        // the runtime takes the tag as the last member
+        pushWord(lama::runtime::Word{tagHash});
+
+        lama::runtime::native_int_t *arrayPtr = reinterpret_cast<lama::runtime::native_int_t *>(peekWordAddress(n + 1));
+
+        lama::runtime::native_uint_t boxedMembers = getBoxedIntAsUInt(n + 1);
+        lama::runtime::Word sexpWord{reinterpret_cast<lama::runtime::native_uint_t>(::Bsexp(arrayPtr, boxedMembers))};
 
-    popWords(n + 1);
-    pushWord(sexpPtr);
+        popWords(n + 1);
+        pushWord(sexpWord);
+    }
 
-    DO_IF_DEBUG(std::cout << "SEXP\t\"" << sexpTagStr << "\"\t" << n << "\n");
+    DO_IF_DEBUG(std::cout << "SEXP\t\"" << getString(instr) << "\"\t" << n << "\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeSti() {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeSti() {
     const lama::runtime::Word value = popWord();
     void *valueAsPtr = reinterpret_cast<void *>(getNativeUIntRepresentation(value));
 
@@ -322,7 +404,8 @@ void lama::interpreter::BytecodeInterpreterState::executeSti() {
     DO_IF_DEBUG(std::cout << "STI\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeSta() {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeSta(const DecodedInstruction &instr) {
     const lama::runtime::Word value = popWord();
     void *valueAsPtr = reinterpret_cast<void *>(getNativeUIntRepresentation(value));
 
@@ -331,7 +414,17 @@ void lama::interpreter::BytecodeInterpreterState::executeSta() {
     const lama::interpreter::runtime::Value dst = popValue();
     lama::runtime::Word *dstPtr;
 
-    if (dst.isInt()) {
+    /*
+     * The verifier has already counted the operands of the instruction, so an element store
+     * with an index that turns out not to be an integer must not be executed as a reference store
+     */
+    const StoreDestination destination = static_cast<StoreDestination>(instr.operand0);
+
+    if (destination == StoreDestination::ELEMENT) {
+        interpreterAssert(dst.isInt(), "array index must be an integer");
+    }
+
+    if (destination != StoreDestination::REFERENCE && dst.isInt()) {
         index = getBoxedIntAsUInt(dst.getNativeInt());
         dstPtr = reinterpret_cast<lama::runtime::Word *>(getNativeUIntRepresentation(popWord()));
     } else {
@@ -346,30 +439,31 @@ void lama::interpreter::BytecodeInterpreterState::executeSta() {
     DO_IF_DEBUG(std::cout << "STA\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeJmp() {
-    const std::int32_t jmpAddress = fetchInt32();
-
-    checkCodeOffset(jmpAddress);
-    setIp(jmpAddress);
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeJmp(const DecodedInstruction &instr) {
+    setIp(instr.operand0);
 
     DO_IF_DEBUG(std::cout << "JMP\t"
-              << std::hex << std::showbase << jmpAddress
+              << std::hex << std::showbase << lookupInstruction(instr.operand0).offset
               << std::dec << '\n');
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeEnd() {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeEnd() {
     doReturnFromFunction();
 
     DO_IF_DEBUG(std::cout << "END\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeRet() {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeRet() {
     doReturnFromFunction();
 
     DO_IF_DEBUG(std::cout << "RET\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::doReturnFromFunction() {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::doReturnFromFunction() {
     const CallstackFrame currentFrame = popFrame();
 
     const lama::runtime::Word result = popWord();
@@ -389,20 +483,23 @@ void lama::interpreter::BytecodeInterpreterState::doReturnFromFunction() {
     setIp(retIp);
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeDrop() {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeDrop() {
     popWord();
 
     DO_IF_DEBUG(std::cout << "DROP\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeDup() {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeDup() {
     lama::runtime::Word top = peekWord();
     pushWord(top);
 
     DO_IF_DEBUG(std::cout << "DUP\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeSwap() {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeSwap() {
     lama::runtime::Word fst = popWord();
     lama::runtime::Word snd = popWord();
 
@@ -412,7 +509,8 @@ void lama::interpreter::BytecodeInterpreterState::executeSwap() {
     DO_IF_DEBUG(std::cout << "SWAP\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeElem() {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeElem() {
     const lama::runtime::native_uint_t boxedIndex = getNativeUIntRepresentation(popWord());
     const std::uintptr_t ptrval = getNativeUIntRepresentation(popWord());
 
@@ -422,8 +520,9 @@ void lama::interpreter::BytecodeInterpreterState::executeElem() {
     DO_IF_DEBUG(std::cout << "ELEM\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeLoadGlobalValue() {
-    const std::int32_t globalIndex = fetchInt32();
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeLoadGlobalValue(const DecodedInstruction &instr) {
+    const std::int32_t globalIndex = instr.operand0;
 
     const lama::runtime::Word globalValue = getGlobalValue(globalIndex);
 
@@ -432,47 +531,42 @@ void lama::interpreter::BytecodeInterpreterState::executeLoadGlobalValue() {
     DO_IF_DEBUG(std::cout << "LD\tG(" << globalIndex << ")\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeLoadLocalValue() {
-    const std::int32_t localIndex = fetchInt32();
-
-    const CallstackFrame currentFrame = peekFrame();
-    checkLocalValueIndex(currentFrame, localIndex);
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeLoadLocalValue(const DecodedInstruction &instr) {
+    const std::int32_t localIndex = instr.operand0;
 
-    const lama::runtime::Word localValue = currentFrame.getLocalValue(localIndex);
+    const lama::runtime::Word localValue = getLocalValue(localIndex);
 
     pushWord(localValue);
 
     DO_IF_DEBUG(std::cout << "LD\tL(" << localIndex << ")\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeLoadArgumentValue() {
-    const std::int32_t argIndex = fetchInt32();
-
-    const CallstackFrame currentFrame = peekFrame();
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeLoadArgumentValue(const DecodedInstruction &instr) {
+    const std::int32_t argIndex = instr.operand0;
 
-    checkArgumentValueIndex(currentFrame, argIndex);
-    const lama::runtime::Word argValue = currentFrame.getArgumentValue(argIndex);
+    const lama::runtime::Word argValue = getArgumentValue(argIndex);
 
     pushWord(argValue);
 
     DO_IF_DEBUG(std::cout << "LD\tA(" << argIndex << ")\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeLoadCapturedValue() {
-    const std::int32_t capturedValIndex = fetchInt32();
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeLoadCapturedValue(const DecodedInstruction &instr) {
+    const std::int32_t capturedValIndex = instr.operand0;
 
-    const CallstackFrame currentFrame = peekFrame();
-
-    checkCapturedValueIndex(currentFrame, capturedValIndex);
-    const lama::runtime::Word capturedValue = currentFrame.getCapturedValue(capturedValIndex);
+    const lama::runtime::Word capturedValue = getCapturedValue(capturedValIndex);
 
     pushWord(capturedValue);
 
     DO_IF_DEBUG(std::cout << "LD\tC(" << capturedValIndex << ")\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeLoadGlobalValueAddress() {
-    const std::int32_t globalValIndex = fetchInt32();
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeLoadGlobalValueAddress(const DecodedInstruction &instr) {
+    const std::int32_t globalValIndex = instr.operand0;
 
     lama::runtime::Word *globalValPtr = getGlobalValueAddress(globalValIndex);
 
@@ -481,47 +575,42 @@ void lama::interpreter::BytecodeInterpreterState::executeLoadGlobalValueAddress(
     DO_IF_DEBUG(std::cout << "LDA\tG(" << globalValIndex << ")\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeLoadLocalValueAddress() {
-    const std::int32_t localValIndex = fetchInt32();
-
-    CallstackFrame currentFrame = peekFrame();
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeLoadLocalValueAddress(const DecodedInstruction &instr) {
+    const std::int32_t localValIndex = instr.operand0;
 
-    checkLocalValueIndex(currentFrame, localValIndex);
-    lama::runtime::Word* localValPtr = currentFrame.getLocalValueAddress(localValIndex);
+    lama::runtime::Word* localValPtr = getLocalValueAddress(localValIndex);
 
     pushValue(localValPtr);
 
     DO_IF_DEBUG(std::cout << "LDA\tL(" << localValIndex << ")\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeLoadArgumentValueAddress() {
-    const std::int32_t argIndex = fetchInt32();
-
-    CallstackFrame currentFrame = peekFrame();
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeLoadArgumentValueAddress(const DecodedInstruction &instr) {
+    const std::int32_t argIndex = instr.operand0;
 
-    checkArgumentValueIndex(currentFrame, argIndex);
-    lama::runtime::Word* argPtr = currentFrame.getArgumentValueAddress(argIndex);
+    lama::runtime::Word* argPtr = getArgumentValueAddress(argIndex);
 
     pushValue(argPtr);
 
     DO_IF_DEBUG(std::cout << "LDA\tA(" << argIndex << ")\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeLoadCapturedValueAddress() {
-    const std::int32_t capturedValIndex = fetchInt32();
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeLoadCapturedValueAddress(const DecodedInstruction &instr) {
+    const std::int32_t capturedValIndex = instr.operand0;
 
-    const CallstackFrame currentFrame = peekFrame();
-
-    checkCapturedValueIndex(currentFrame, capturedValIndex);
-    const lama::runtime::Word *capturedValuePtr = currentFrame.getCapturedValueAddress(capturedValIndex);
+    const lama::runtime::Word *capturedValuePtr = getCapturedValueAddress(capturedValIndex);
 
     pushValue(capturedValuePtr);
 
     DO_IF_DEBUG(std::cout << "LDA\tC(" << capturedValIndex << ")\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeStoreGlobalValue() {
-    const std::int32_t globalIndex = fetchInt32();
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeStoreGlobalValue(const DecodedInstruction &instr) {
+    const std::int32_t globalIndex = instr.operand0;
     const lama::runtime::Word value = popWord();
 
     setGlobalValue(globalIndex, value);
@@ -531,51 +620,45 @@ void lama::interpreter::BytecodeInterpreterState::executeStoreGlobalValue() {
     DO_IF_DEBUG(std::cout << "ST\tG(" << globalIndex << ")\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeStoreLocalValue() {
-    const std::int32_t localIndex = fetchInt32();
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeStoreLocalValue(const DecodedInstruction &instr) {
+    const std::int32_t localIndex = instr.operand0;
     const lama::runtime::Word value = popWord();
 
-    CallstackFrame currentFrame = peekFrame();
-
-    checkLocalValueIndex(currentFrame, localIndex);
-    currentFrame.setLocalValue(localIndex, value);
+    setLocalValue(localIndex, value);
 
     pushWord(value);
 
     DO_IF_DEBUG(std::cout << "ST\tL(" << localIndex << ")\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeStoreArgumentValue() {
-    const std::int32_t argumentIndex = fetchInt32();
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeStoreArgumentValue(const DecodedInstruction &instr) {
+    const std::int32_t argumentIndex = instr.operand0;
     const lama::runtime::Word value = popWord();
 
-    CallstackFrame currentFrame = peekFrame();
-
-    checkArgumentValueIndex(currentFrame, argumentIndex);
-    currentFrame.setArgumentValue(argumentIndex, value);
+    setArgumentValue(argumentIndex, value);
 
     pushWord(value);
 
     DO_IF_DEBUG(std::cout << "ST\tA(" << argumentIndex << ")\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeStoreCapturedValue() {
-    const std::int32_t capturedValIndex = fetchInt32();
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeStoreCapturedValue(const DecodedInstruction &instr) {
+    const std::int32_t capturedValIndex = instr.operand0;
     const lama::runtime::Word value = popWord();
 
-    CallstackFrame currentFrame = peekFrame();
-
-    checkCapturedValueIndex(currentFrame, capturedValIndex);
-    currentFrame.setCapturedValue(capturedValIndex, value);
+    setCapturedValue(capturedValIndex, value);
 
     pushWord(value);
 
     DO_IF_DEBUG(std::cout << "ST\tC(" << capturedValIndex << ")\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeConditionalJmpIfZero() {
-    const std::int32_t nextIp = fetchInt32();
-    checkCodeOffset(nextIp);
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeConditionalJmpIfZero(const DecodedInstruction &instr) {
+    const instr_index_t nextIp = instr.operand0;
 
     const lama::runtime::native_int_t val = popIntValue().getNativeInt();
 
@@ -584,13 +667,13 @@ void lama::interpreter::BytecodeInterpreterState::executeConditionalJmpIfZero()
     }
 
     DO_IF_DEBUG(std::cout << "CJMPz\t"
-              << std::hex << std::showbase << nextIp
+              << std::hex << std::showbase << lookupInstruction(nextIp).offset
               << std::dec << '\n');
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeConditionalJmpIfNotZero() {
-    const std::int32_t nextIp = fetchInt32();
-    checkCodeOffset(nextIp);
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeConditionalJmpIfNotZero(const DecodedInstruction &instr) {
+    const instr_index_t nextIp = instr.operand0;
 
     const lama::runtime::native_int_t val = popIntValue().getNativeInt();
 
@@ -599,21 +682,46 @@ void lama::interpreter::BytecodeInterpreterState::executeConditionalJmpIfNotZero
     }
 
     DO_IF_DEBUG(std::cout << "CJMPnz\t"
-              << std::hex << std::showbase << nextIp
+              << std::hex << std::showbase << lookupInstruction(nextIp).offset
               << std::dec << '\n');
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeBegin() {
-    const std::int32_t argsNum = fetchInt32();
-    DO_IF_DYN_VER(checkNonNegative(argsNum, "arguments number must not be negative"));
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeIntConditionalJmpIfZero(const DecodedInstruction &instr) {
+    const instr_index_t nextIp = instr.operand0;
+
+    if (popValue().getNativeInt() == 0) {
+        setIp(nextIp);
+    }
+
+    DO_IF_DEBUG(std::cout << "CJMPz\t"
+              << std::hex << std::showbase << lookupInstruction(nextIp).offset
+              << std::dec << '\n');
+}
 
-    const std::int32_t val = fetchInt32();
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeIntConditionalJmpIfNotZero(const DecodedInstruction &instr) {
+    const instr_index_t nextIp = instr.operand0;
 
-    const std::int16_t localsNum = val & 0xffff;
+    if (popValue().getNativeInt() != 0) {
+        setIp(nextIp);
+    }
+
+    DO_IF_DEBUG(std::cout << "CJMPnz\t"
+              << std::hex << std::showbase << lookupInstruction(nextIp).offset
+              << std::dec << '\n');
+}
+
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeBegin(const DecodedInstruction &instr) {
+    const std::int32_t argsNum = instr.operand0;
+    DO_IF_DYN_VER(checkNonNegative(argsNum, "arguments number must not be negative"));
+
+    const std::int32_t localsNum = instr.operand1;
     DO_IF_DYN_VER(checkNonNegative(localsNum, "locals number must not be negative"));
 
-    if (mode_ == lama::interpreter::VerificationMode::STATIC_VERIFICATION) {
-        const std::uint16_t frameStackSize = (static_cast<std::uint32_t>(val) >> 16) & 0xffff;
+    if constexpr (!DYNAMIC_CHECKS) {
+        const std::uint32_t frameStackSize = instr.operand2;
         checkStackOverflow(stack_.size() + localsNum + frameStackSize);
     }
 
@@ -622,16 +730,16 @@ void lama::interpreter::BytecodeInterpreterState::executeBegin() {
     DO_IF_DEBUG(std::cout << "BEGIN\t" << argsNum << "\t" << localsNum << '\n');
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeClosureBegin() {
-    const std::int32_t argsNum = fetchInt32();
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeClosureBegin(const DecodedInstruction &instr) {
+    const std::int32_t argsNum = instr.operand0;
     DO_IF_DYN_VER(checkNonNegative(argsNum, "arguments number must not be negative"));
 
-    const std::int32_t val = fetchInt32();
-    const std::int16_t localsNum = val & 0xffff;
+    const std::int32_t localsNum = instr.operand1;
     DO_IF_DYN_VER(checkNonNegative(localsNum, "locals number must not be negative"));
 
-    if (mode_ == lama::interpreter::VerificationMode::STATIC_VERIFICATION) {
-        const std::uint16_t frameStackSize = (static_cast<std::uint32_t>(val) >> 16) & 0xffff;
+    if constexpr (!DYNAMIC_CHECKS) {
+        const std::uint32_t frameStackSize = instr.operand2;
         checkStackOverflow(stack_.size() + localsNum + frameStackSize);
     }
 
@@ -640,7 +748,18 @@ void lama::interpreter::BytecodeInterpreterState::executeClosureBegin() {
     DO_IF_DEBUG(std::cout << "CBEGIN\t" << argsNum << "\t" << localsNum << '\n');
 }
 
-void lama::interpreter::BytecodeInterpreterState::processFunctionBegin(std::size_t argsNum, std::size_t localsNum, bool hasCaptures) {
+/*
+ * The verifier patches the function including this instruction, which becomes BEGIN or CBEGIN,
+ * so the function is entered as if it had been verified in advance
+ */
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeUnverifiedBegin(const DecodedInstruction &instr) {
+    lazyVerifier_->verifyFunction(instr.offset, instr.operand0);
+    executeInstruction(instr);
+}
+
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::processFunctionBegin(std::uint32_t argsNum, std::uint32_t localsNum, bool hasCaptures) {
     if (hasCaptures) {
         lama::interpreter::runtime::Value closureValue{peekWord(1 + argsNum + 1)}; // retIp + argsNum + closure
 
@@ -655,59 +774,61 @@ void lama::interpreter::BytecodeInterpreterState::processFunctionBegin(std::size
         /* hasCaptures = */ hasCaptures,
     });
 
-    for (std::int32_t i = 0; i < localsNum; ++i) {
+    for (std::uint32_t i = 0; i < localsNum; ++i) {
         pushValue(lama::runtime::native_int_t{0});
     }
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeClosure() {
-    const std::int32_t locationAddress = fetchInt32();
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeClosure(const DecodedInstruction &instr) {
+    const std::int32_t locationAddress = instr.operand0;
     checkCodeOffset(locationAddress);
 
-    const std::int32_t argsNum = fetchInt32();
+    const std::int32_t argsNum = instr.operand1;
     DO_IF_DYN_VER(checkNonNegative(argsNum, "arguments number must not be negative"));
 
-    pushWord(lama::runtime::Word(locationAddress));
-
-    const std::int32_t captureIp = getIp();
-
-    for (std::int32_t i = 0; i < argsNum; ++i) {
-        lama::runtime::Word w;
-
-        CaptureType captureType{std::to_integer<unsigned char>(fetchByte())};
-        const std::int32_t index = fetchInt32();
+    const auto getCapture = [this, &instr](std::size_t i) {
+        lama::runtime::Word w{};
 
-        lama::interpreter::CallstackFrame frame = peekFrame();
+        const auto [captureType, index] = instr.captures[i];
 
         switch (captureType) {
             case CaptureType::GLOBAL:
                 w = getGlobalValue(index);
                 break;
             case CaptureType::LOCAL:
-                checkLocalValueIndex(frame, index);
-                w = frame.getLocalValue(index);
+                w = getLocalValue(index);
                 break;
             case CaptureType::ARGUMENT:
-                checkArgumentValueIndex(frame, index);
-                w = frame.getArgumentValue(index);
+                w = getArgumentValue(index);
                 break;
             case CaptureType::CAPTURE:
-                checkCapturedValueIndex(frame, index);
-                w = frame.getCapturedValue(index);
+                w = getCapturedValue(index);
                 break;
             default:
                 DO_IF_DYN_VER(interpreterAssert(false, "invalid varspec"));
                 break;
         }
 
-        pushWord(w);
-    }
+        return w;
+    };
+
+    void *closurePtr = lama::interpreter::runtime::tryAllocateClosure(lama::runtime::Word(locationAddress), argsNum, getCapture);
+
+    // the captured values are passed to the runtime on the stack, so that they are GC roots
+    if (closurePtr == nullptr) {
+        pushWord(lama::runtime::Word(locationAddress));
+
+        for (std::int32_t i = 0; i < argsNum; ++i) {
+            pushWord(getCapture(i));
+        }
 
-    lama::runtime::native_int_t *ptrval = reinterpret_cast<lama::runtime::native_int_t *>(peekWordAddress(argsNum + 1));
+        lama::runtime::native_int_t *ptrval = reinterpret_cast<lama::runtime::native_int_t *>(peekWordAddress(argsNum + 1));
 
-    void *closurePtr = ::Bclosure(ptrval, getBoxedIntAsUInt(argsNum));
+        closurePtr = ::Bclosure(ptrval, getBoxedIntAsUInt(argsNum));
 
-    popWords(argsNum + 1);
+        popWords(argsNum + 1);
+    }
 
     pushValue(closurePtr);
 
@@ -717,14 +838,8 @@ void lama::interpreter::BytecodeInterpreterState::executeClosure() {
               << std::hex << std::showbase
               << locationAddress << std::dec;
 
-    std::int32_t lookupIp = captureIp;
-
     for (std::int32_t i = 0; i < argsNum; ++i) {
-        CaptureType captureType{std::to_integer<unsigned char>(lookupByte(lookupIp))};
-        lookupIp += sizeof(std::byte);
-
-        const std::int32_t index = lookupInt32(lookupIp);
-        lookupIp += sizeof(std::int32_t);
+        const auto [captureType, index] = instr.captures[i];
 
         switch (captureType) {
             case CaptureType::GLOBAL:
@@ -747,57 +862,171 @@ void lama::interpreter::BytecodeInterpreterState::executeClosure() {
     #endif
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeCallClosure() {
-    const std::int32_t argsNum = fetchInt32();
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeCallClosure(const DecodedInstruction &instr) {
+    doCallClosure(instr, lama::interpreter::runtime::Value{lama::runtime::native_int_t{getIp()}}.getRawWord());
+}
+
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::doCallClosure(const DecodedInstruction &instr, lama::runtime::Word retIp) {
+    const std::int32_t argsNum = instr.operand0;
     DO_IF_DYN_VER(checkNonNegative(argsNum, "arguments number must not be negative"));
 
     const lama::runtime::Word closurePtrWord = peekWord(argsNum + 1);
     const lama::runtime::native_int_t *closureContentPtr = reinterpret_cast<const lama::runtime::native_int_t *>(closurePtrWord);
 
     const std::int32_t locationAddress = closureContentPtr[0];
-    checkCodeOffset(locationAddress);
-    lama::bytecode::InstructionOpCode startOp = lookupInstrOpCode(locationAddress);
+    CallSiteCache &cache = callSiteCaches_[instr.operand1];
+
+    DO_IF_DEBUG(std::cout << "CALLC\t" << argsNum << '\n');
+
+    if (cache.codeOffset == locationAddress) {
+        pushWord(retIp);
+        isClosureCalled_ = true;
+
+        // enter the function as BEGIN does, errors are still reported at the BEGIN instruction
+        setIp(cache.beginIndex);
+        fetchInstruction();
+
+        if constexpr (!DYNAMIC_CHECKS) {
+            checkStackOverflow(stack_.size() + cache.localsNum + cache.frameStackSize);
+        }
+
+        processFunctionBegin(cache.argsNum, cache.localsNum, cache.hasCaptures);
+
+        return;
+    }
+
+    const instr_index_t location = getInstructionIndex(locationAddress);
+    const DecodedInstruction &begin = lookupInstruction(location);
+
+    // the callee is verified before its frame layout is cached
+    if (begin.opcode == pseudo_opcode::UNVERIFIED_BEGIN || begin.opcode == pseudo_opcode::UNVERIFIED_CBEGIN) {
+        lazyVerifier_->verifyFunction(begin.offset, begin.operand0);
+    }
+
+    const lama::bytecode::InstructionOpCode startOp = begin.opcode;
     interpreterAssert(
         startOp == lama::bytecode::InstructionOpCode::BEGIN || startOp == lama::bytecode::InstructionOpCode::CBEGIN,
         "CALLC should go to BEGIN or CBEGIN instruction"
     );
 
-    pushValue(lama::runtime::native_int_t{getIp()});
+    if (begin.operand0 >= 0 && begin.operand1 >= 0) {
+        cache = CallSiteCache{
+            /* codeOffset     = */ locationAddress,
+            /* beginIndex     = */ location,
+            /* argsNum        = */ static_cast<std::uint32_t>(begin.operand0),
+            /* localsNum      = */ static_cast<std::uint32_t>(begin.operand1),
+            /* frameStackSize = */ static_cast<std::uint32_t>(begin.operand2),
+            /* hasCaptures    = */ startOp == lama::bytecode::InstructionOpCode::CBEGIN,
+        };
+    }
+
+    pushWord(retIp);
 
-    setIp(locationAddress);
+    setIp(location);
     isClosureCalled_ = true;
+}
 
-    DO_IF_DEBUG(std::cout << "CALLC\t" << argsNum << '\n');
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeCall(const DecodedInstruction &instr) {
+    doCall(instr, lama::interpreter::runtime::Value{lama::runtime::native_int_t{getIp()}}.getRawWord());
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeCall() {
-    const std::int32_t locationAddress = fetchInt32();
-    checkCodeOffset(locationAddress);
-    lama::bytecode::InstructionOpCode startOp = lookupInstrOpCode(locationAddress);
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::doCall(const DecodedInstruction &instr, lama::runtime::Word retIp) {
+    const instr_index_t location = instr.operand0;
+    lama::bytecode::InstructionOpCode startOp = lookupInstruction(location).opcode;
+    DO_IF_DYN_VER(checkJumpTarget(lookupInstruction(location)));
     DO_IF_DYN_VER(interpreterAssert(
         startOp == lama::bytecode::InstructionOpCode::BEGIN,
         "CALL should go to BEGIN instruction"
     ));
 
-    const std::int32_t argsNum = fetchInt32();
+    const std::int32_t argsNum = instr.operand1;
     DO_IF_DYN_VER(checkNonNegative(argsNum, "arguments number must not be negative"));
 
-    pushValue(lama::runtime::native_int_t{getIp()});
+    pushWord(retIp);
 
-    setIp(locationAddress);
+    setIp(location);
     isClosureCalled_ = false;
 
     DO_IF_DEBUG(std::cout << std::hex << std::showbase
-              << "CALL\t" << locationAddress << "\t" << argsNum
+              << "CALL\t" << lookupInstruction(location).offset << "\t" << argsNum
               << std::dec << '\n');
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeTag() {
-    const std::int32_t sexpTagPos = fetchInt32();
-    const std::string_view sexpTagStr = getString(sexpTagPos);
-    const lama::runtime::native_int_t tagHash = ::LtagHash(const_cast<char *>(sexpTagStr.data()));
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeTailCallClosure(const DecodedInstruction &instr) {
+    const std::int32_t argsNum = instr.operand0;
+    DO_IF_DYN_VER(checkNonNegative(argsNum, "arguments number must not be negative"));
+
+    // the closure is moved along with the arguments
+    if (!canReuseFrame(argsNum + 1)) {
+        executeCallClosure(instr);
+        return;
+    }
+
+    doCallClosure(instr, reuseFrame(argsNum + 1));
+}
+
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeTailCall(const DecodedInstruction &instr) {
+    const std::int32_t argsNum = instr.operand1;
+    DO_IF_DYN_VER(checkNonNegative(argsNum, "arguments number must not be negative"));
+
+    if (!canReuseFrame(argsNum)) {
+        executeCall(instr);
+        return;
+    }
+
+    doCall(instr, reuseFrame(argsNum));
+}
+
+/*
+ * Verified code always has the callee arguments above the locals of the current frame,
+ * otherwise the call is performed as a usual one and the END instruction reports errors after it
+ */
+template<lama::interpreter::VerificationMode Mode>
+bool lama::interpreter::BytecodeInterpreterState<Mode>::canReuseFrame(std::size_t wordsNum) const {
+    if constexpr (DYNAMIC_CHECKS) {
+        const CallstackFrame &frame = peekFrame();
+        const lama::runtime::Word *localsEnd = frame.getLocalValueAddress(frame.getLocalsCount());
+        const std::size_t frameBaseIndex = frame.getFrameBase() - stack_.data();
+        const std::size_t frameArgsWords = frame.getArgumentsCount() + (frame.hasClosure() ? 1 : 0);
+
+        return frameArgsWords <= frameBaseIndex
+               && stack_.size() >= wordsNum
+               && stack_.peekAddress(wordsNum) >= localsEnd;
+    }
+
+    return true;
+}
+
+/*
+ * Pops the current frame and moves the given number of words from the top of the operand stack
+ * to the place of its arguments (and closure), returns the return address of the frame
+ */
+template<lama::interpreter::VerificationMode Mode>
+lama::runtime::Word lama::interpreter::BytecodeInterpreterState<Mode>::reuseFrame(std::size_t wordsNum) {
+    CallstackFrame frame = popFrame();
+
+    const lama::runtime::Word retIp = *frame.getFrameBase();
+
+    lama::runtime::Word *words = peekWordAddress(wordsNum);
+    lama::runtime::Word *frameStart = frame.getArgumentValueAddress(0) - (frame.hasClosure() ? 1 : 0);
 
-    const std::int32_t n = fetchInt32();
+    std::memmove(frameStart, words, wordsNum * sizeof(lama::runtime::Word));
+    stack_.setEnd(frameStart + wordsNum);
+
+    return retIp;
+}
+
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeTag(const DecodedInstruction &instr) {
+    const lama::runtime::native_int_t tagHash = getTagHash(instr);
+
+    const std::int32_t n = instr.operand1;
     DO_IF_DYN_VER(checkNonNegative(n, "sexp members count must not be negative"));
     const lama::runtime::native_uint_t boxedMembers = getBoxedIntAsUInt(n);
 
@@ -805,11 +1034,12 @@ void lama::interpreter::BytecodeInterpreterState::executeTag() {
 
     pushWord(lama::runtime::Word(::Btag(reinterpret_cast<void *>(ptrval), tagHash, boxedMembers)));
 
-    DO_IF_DEBUG(std::cout << "TAG\t\"" << sexpTagStr << "\"\t" << n << '\n');
+    DO_IF_DEBUG(std::cout << "TAG\t\"" << getString(instr) << "\"\t" << n << '\n');
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeArray() {
-    const std::int32_t n = fetchInt32();
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeArray(const DecodedInstruction &instr) {
+    const std::int32_t n = instr.operand0;
     DO_IF_DYN_VER(checkNonNegative(n, "array length must not be negative"));
 
     const lama::interpreter::runtime::Value boxedLenVal = lama::runtime::native_int_t{n};
@@ -824,12 +1054,13 @@ void lama::interpreter::BytecodeInterpreterState::executeArray() {
               << "ARRAY\t" << n << '\n');
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeFail() {
-    const std::int32_t lineNum = fetchInt32();
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeFail(const DecodedInstruction &instr) {
+    const std::int32_t lineNum = instr.operand0;
     DO_IF_DYN_VER(interpreterAssert(lineNum >= 1, "line number must be greater than zero"));
     const lama::runtime::native_uint_t boxedLineNum = getBoxedIntAsUInt(lineNum);
 
-    const std::int32_t colNum = fetchInt32();
+    const std::int32_t colNum = instr.operand1;
     DO_IF_DYN_VER(interpreterAssert(colNum >= 1, "column number must be greater than zero"));
     const lama::runtime::native_uint_t boxedColNum = getBoxedIntAsUInt(colNum);
 
@@ -840,13 +1071,15 @@ void lama::interpreter::BytecodeInterpreterState::executeFail() {
     DO_IF_DEBUG(std::cout << "FAIL\t" << lineNum << "\t" << colNum << '\n');
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeLine() {
-    const std::int32_t lineNum = fetchInt32();
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeLine(const DecodedInstruction &instr) {
+    const std::int32_t lineNum = instr.operand0;
 
     DO_IF_DEBUG(std::cout << "LINE\t" << lineNum << '\n');
 }
 
-void lama::interpreter::BytecodeInterpreterState::executePattStr() {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executePattStr() {
     const std::uintptr_t y = getNativeUIntRepresentation(popWord());
     void *str1 = reinterpret_cast<void *>(y);
 
@@ -858,7 +1091,8 @@ void lama::interpreter::BytecodeInterpreterState::executePattStr() {
     DO_IF_DEBUG(std::cout << "PATT\t=str\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executePattString() {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executePattString() {
     const std::uintptr_t ptrval = getNativeUIntRepresentation(popWord());
 
     pushWord(lama::runtime::Word(::Bstring_tag_patt(reinterpret_cast<void *>(ptrval))));
@@ -866,7 +1100,8 @@ void lama::interpreter::BytecodeInterpreterState::executePattString() {
     DO_IF_DEBUG(std::cout << "PATT\t#string\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executePattArray() {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executePattArray() {
     const std::uintptr_t ptrval = getNativeUIntRepresentation(popWord());
 
     pushWord(lama::runtime::Word(::Barray_tag_patt(reinterpret_cast<void *>(ptrval))));
@@ -874,7 +1109,8 @@ void lama::interpreter::BytecodeInterpreterState::executePattArray() {
     DO_IF_DEBUG(std::cout << "PATT\t#array\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executePattSexp() {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executePattSexp() {
     const std::uintptr_t ptrval = getNativeUIntRepresentation(popWord());
 
     pushWord(lama::runtime::Word(::Bsexp_tag_patt(reinterpret_cast<void *>(ptrval))));
@@ -882,7 +1118,8 @@ void lama::interpreter::BytecodeInterpreterState::executePattSexp() {
     DO_IF_DEBUG(std::cout << "PATT\t#sexp\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executePattRef() {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executePattRef() {
     const std::uintptr_t ptrval = getNativeUIntRepresentation(popWord());
 
     pushWord(lama::runtime::Word(::Bboxed_patt(reinterpret_cast<void *>(ptrval))));
@@ -890,7 +1127,8 @@ void lama::interpreter::BytecodeInterpreterState::executePattRef() {
     DO_IF_DEBUG(std::cout << "PATT\t#ref\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executePattVal() {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executePattVal() {
     const std::uintptr_t ptrval = getNativeUIntRepresentation(popWord());
 
     pushWord(lama::runtime::Word(::Bunboxed_patt(reinterpret_cast<void *>(ptrval))));
@@ -898,7 +1136,8 @@ void lama::interpreter::BytecodeInterpreterState::executePattVal() {
     DO_IF_DEBUG(std::cout << "PATT\t#val\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executePattFun() {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executePattFun() {
     const std::uintptr_t ptrval = getNativeUIntRepresentation(popWord());
 
     pushWord(lama::runtime::Word(::Bclosure_tag_patt(reinterpret_cast<void *>(ptrval))));
@@ -906,7 +1145,8 @@ void lama::interpreter::BytecodeInterpreterState::executePattFun() {
     DO_IF_DEBUG(std::cout << "PATT\t#fun\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeCallLread() {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeCallLread() {
     const lama::runtime::Word w{static_cast<lama::runtime::native_uint_t>(::Lread())};
 
     pushWord(w);
@@ -914,17 +1154,20 @@ void lama::interpreter::BytecodeInterpreterState::executeCallLread() {
     DO_IF_DEBUG(std::cout << "CALL\tLread\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeCallLwrite() {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeCallLwrite() {
     const lama::interpreter::runtime::Value val = popIntValue();
 
     ::Lwrite(getNativeUIntRepresentation(val.getRawWord()));
 
-    pushWord(lama::runtime::Word{});
+    // the raw 0 returned by the runtime is not a Lama value, so the result is pushed as a boxed 0
+    pushValue(lama::interpreter::runtime::Value(lama::runtime::native_int_t(0)));
 
     DO_IF_DEBUG(std::cout << "CALL\tLwrite\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeCallLlength() {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeCallLlength() {
     const std::uintptr_t ptrval = getNativeUIntRepresentation(popWord());
 
     pushWord(lama::runtime::Word(::Llength(reinterpret_cast<void *>(ptrval))));
@@ -932,7 +1175,8 @@ void lama::interpreter::BytecodeInterpreterState::executeCallLlength() {
     DO_IF_DEBUG(std::cout << "CALL\tLlength\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeCallLstring() {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeCallLstring() {
     std::uintptr_t ptrval = getNativeUIntRepresentation(popWord());
 
     pushValue(::Lstring(reinterpret_cast<lama::runtime::native_int_t *>(&ptrval)));
@@ -940,13 +1184,18 @@ void lama::interpreter::BytecodeInterpreterState::executeCallLstring() {
     DO_IF_DEBUG(std::cout << "CALL\tLstring\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeCallBarray() {
-    const std::int32_t n = fetchInt32();
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeCallBarray(const DecodedInstruction &instr) {
+    const std::int32_t n = instr.operand0;
     lama::runtime::native_uint_t boxedLen = getBoxedIntAsUInt(n);
 
-    lama::runtime::native_int_t *arrayPtr = reinterpret_cast<lama::runtime::native_int_t *>(peekWordAddress(n));
+    lama::runtime::Word *elements = peekWordAddress(n);
+
+    const void *allocatedArray = lama::interpreter::runtime::tryAllocateArray(elements, n);
 
-    const void *allocatedArray = Barray(arrayPtr, boxedLen);
+    if (allocatedArray == nullptr) {
+        allocatedArray = Barray(reinterpret_cast<lama::runtime::native_int_t *>(elements), boxedLen);
+    }
 
     popWords(n);
 
@@ -955,21 +1204,148 @@ void lama::interpreter::BytecodeInterpreterState::executeCallBarray() {
     DO_IF_DEBUG(std::cout << std::dec << "CALL\tBarray " << n << "\n");
 }
 
-void lama::interpreter::BytecodeInterpreterState::executeCurrentInstruction() {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeInvalidJump(const DecodedInstruction &instr) {
+    checkJumpTarget(instr);
+}
+
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeEndOfCode() {
+    interpreterAssert(false, "code offset out of range");
+}
+
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeLoadLocalValueConst(const DecodedInstruction &instr) {
+    executeLoadLocalValue(instr);
+    executeConst(fetchInstruction());
+}
+
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeLoadArgumentValueConst(const DecodedInstruction &instr) {
+    executeLoadArgumentValue(instr);
+    executeConst(fetchInstruction());
+}
+
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeConstAdd(const DecodedInstruction &instr) {
+    const lama::runtime::native_int_t y = lama::interpreter::runtime::Value{lama::runtime::Word(instr.operand0)}.getNativeInt();
+
+    // type errors belong to BINOP
+    fetchInstruction();
+    const lama::runtime::native_int_t x = popIntValue().getNativeInt();
+
+    pushValue(lama::runtime::native_int_t{x + y});
+
+    DO_IF_DEBUG(std::cout << "CONST\t" << y << '\n' << "BINOP\t+\n");
+}
+
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeConstSub(const DecodedInstruction &instr) {
+    const lama::runtime::native_int_t y = lama::interpreter::runtime::Value{lama::runtime::Word(instr.operand0)}.getNativeInt();
+
+    // type errors belong to BINOP
+    fetchInstruction();
+    const lama::runtime::native_int_t x = popIntValue().getNativeInt();
+
+    pushValue(lama::runtime::native_int_t{x - y});
+
+    DO_IF_DEBUG(std::cout << "CONST\t" << y << '\n' << "BINOP\t-\n");
+}
+
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeLoadLocalValueCjmpz(const DecodedInstruction &instr) {
+    const std::int32_t localIndex = instr.operand0;
+    const lama::interpreter::runtime::Value val{getLocalValue(localIndex)};
+
+    // the value is tested in place instead of being pushed and popped, the stack still has to have room for it
+    DO_IF_DYN_VER(checkStackOverflow(stack_.size()));
+
+    const instr_index_t nextIp = fetchInstruction().operand0;
+
+    interpreterAssert(val.isInt(), "expected an integer");
+
+    if (val.getNativeInt() == 0) {
+        setIp(nextIp);
+    }
+
+    DO_IF_DEBUG(std::cout << "LD\tL(" << localIndex << ")\n" << "CJMPz\t"
+              << std::hex << std::showbase << lookupInstruction(nextIp).offset
+              << std::dec << '\n');
+}
+
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeLoadArgumentValueCjmpz(const DecodedInstruction &instr) {
+    const std::int32_t argIndex = instr.operand0;
+    const lama::interpreter::runtime::Value val{getArgumentValue(argIndex)};
+
+    DO_IF_DYN_VER(checkStackOverflow(stack_.size()));
+
+    const instr_index_t nextIp = fetchInstruction().operand0;
+
+    interpreterAssert(val.isInt(), "expected an integer");
+
+    if (val.getNativeInt() == 0) {
+        setIp(nextIp);
+    }
+
+    DO_IF_DEBUG(std::cout << "LD\tA(" << argIndex << ")\n" << "CJMPz\t"
+              << std::hex << std::showbase << lookupInstruction(nextIp).offset
+              << std::dec << '\n');
+}
+
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeDupTag() {
+    // TAG reads the duplicate, so the original top is passed to it directly and only the result is pushed
+    const lama::runtime::Word top = peekWord();
+    DO_IF_DYN_VER(checkStackOverflow(stack_.size()));
+
+    const DecodedInstruction &tag = fetchInstruction();
+    const lama::runtime::native_int_t tagHash = getTagHash(tag);
+
+    const std::int32_t n = tag.operand1;
+    DO_IF_DYN_VER(checkNonNegative(n, "sexp members count must not be negative"));
+    const lama::runtime::native_uint_t boxedMembers = getBoxedIntAsUInt(n);
+
+    const lama::runtime::native_uint_t ptrval = getNativeUIntRepresentation(top);
+
+    pushWord(lama::runtime::Word(::Btag(reinterpret_cast<void *>(ptrval), tagHash, boxedMembers)));
+
+    DO_IF_DEBUG(std::cout << "DUP\n" << "TAG\t\"" << getString(tag) << "\"\t" << n << '\n');
+}
+
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeStoreLocalValueDrop(const DecodedInstruction &instr) {
+    const std::int32_t localIndex = instr.operand0;
+    const lama::runtime::Word value = popWord();
+
+    setLocalValue(localIndex, value);
+
+    fetchInstruction();
+
+    DO_IF_DEBUG(std::cout << "ST\tL(" << localIndex << ")\n" << "DROP\n");
+}
+
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeCurrentInstruction() {
     if (isEndReached()) {
         return;
     }
 
-    using lama::bytecode::InstructionOpCode;
-
-    setInstructionStartOffset(getIp());
+    const DecodedInstruction &instr = fetchInstruction();
 
     DO_IF_DEBUG(std::cerr << "[interpreter-debug]: "
               << "ip = " << std::hex << std::showbase << getInstructionStartOffset()
-              << ", op = " << std::to_integer<unsigned int>(lookupByte())
+              << ", op = " << static_cast<unsigned int>(instr.opcode)
               << std::dec << '\n');
 
-    InstructionOpCode op = fetchInstrOpCode();
+    executeInstruction(instr);
+}
+
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::executeInstruction(const DecodedInstruction &instr) {
+    using lama::bytecode::InstructionOpCode;
+
+    const InstructionOpCode op = instr.opcode;
 
     switch (op) {
         case InstructionOpCode::BINOP_ADD:
@@ -988,22 +1364,22 @@ void lama::interpreter::BytecodeInterpreterState::executeCurrentInstruction() {
             executeBinop(op);
             break;
         case InstructionOpCode::CONST:
-            executeConst();
+            executeConst(instr);
             break;
         case InstructionOpCode::STRING:
-            executeString();
+            executeString(instr);
             break;
         case InstructionOpCode::SEXP:
-            executeSexp();
+            executeSexp(instr);
             break;
         case InstructionOpCode::STI:
             executeSti();
             break;
         case InstructionOpCode::STA:
-            executeSta();
+            executeSta(instr);
             break;
         case InstructionOpCode::JMP:
-            executeJmp();
+            executeJmp(instr);
             break;
         case InstructionOpCode::END:
             executeEnd();
@@ -1026,73 +1402,83 @@ void lama::interpreter::BytecodeInterpreterState::executeCurrentInstruction() {
             executeElem();
             break;
         case InstructionOpCode::LD_G:
-            executeLoadGlobalValue();
+            executeLoadGlobalValue(instr);
             break;
         case InstructionOpCode::LD_L:
-            executeLoadLocalValue();
+            executeLoadLocalValue(instr);
             break;
         case InstructionOpCode::LD_A:
-            executeLoadArgumentValue();
+            executeLoadArgumentValue(instr);
             break;
         case InstructionOpCode::LD_C:
-            executeLoadCapturedValue();
+            executeLoadCapturedValue(instr);
             break;
         case InstructionOpCode::LDA_G:
-            executeLoadGlobalValueAddress();
+            executeLoadGlobalValueAddress(instr);
             break;
         case InstructionOpCode::LDA_L:
-            executeLoadLocalValueAddress();
+            executeLoadLocalValueAddress(instr);
             break;
         case InstructionOpCode::LDA_A:
-            executeLoadArgumentValueAddress();
+            executeLoadArgumentValueAddress(instr);
             break;
         case InstructionOpCode::LDA_C:
-            executeLoadCapturedValueAddress();
+            executeLoadCapturedValueAddress(instr);
             break;
         case InstructionOpCode::ST_G:
-            executeStoreGlobalValue();
+            executeStoreGlobalValue(instr);
             break;
         case InstructionOpCode::ST_L:
-            executeStoreLocalValue();
+            executeStoreLocalValue(instr);
             break;
         case InstructionOpCode::ST_A:
-            executeStoreArgumentValue();
+            executeStoreArgumentValue(instr);
             break;
         case InstructionOpCode::ST_C:
-            executeStoreCapturedValue();
+            executeStoreCapturedValue(instr);
             break;
         case InstructionOpCode::CJMPZ:
-            executeConditionalJmpIfZero();
+            executeConditionalJmpIfZero(instr);
             break;
         case InstructionOpCode::CJMPNZ:
-            executeConditionalJmpIfNotZero();
+            executeConditionalJmpIfNotZero(instr);
             break;
         case InstructionOpCode::BEGIN:
-            executeBegin();
+            executeBegin(instr);
             break;
         case InstructionOpCode::CBEGIN:
-            executeClosureBegin();
+            executeClosureBegin(instr);
             break;
         case InstructionOpCode::CLOSURE:
-            executeClosure();
+            executeClosure(instr);
             break;
         case InstructionOpCode::CALLC:
-            executeCallClosure();
+            executeCallClosure(instr);
             break;
         case InstructionOpCode::CALL:
-            executeCall();
+            executeCall(instr);
+            break;
+        case pseudo_opcode::TAIL_CALLC:
+            executeTailCallClosure(instr);
+            break;
+        case pseudo_opcode::TAIL_CALL:
+            executeTailCall(instr);
+            break;
+        case pseudo_opcode::UNVERIFIED_BEGIN:
+        case pseudo_opcode::UNVERIFIED_CBEGIN:
+            executeUnverifiedBegin(instr);
             break;
         case InstructionOpCode::TAG:
-            executeTag();
+            executeTag(instr);
             break;
         case InstructionOpCode::ARRAY:
-            executeArray();
+            executeArray(instr);
             break;
         case InstructionOpCode::FAIL:
-            executeFail();
+            executeFail(instr);
             break;
         case InstructionOpCode::LINE:
-            executeLine();
+            executeLine(instr);
             break;
         case InstructionOpCode::PATT_STR:
             executePattStr();
@@ -1128,7 +1514,58 @@ void lama::interpreter::BytecodeInterpreterState::executeCurrentInstruction() {
             executeCallLstring();
             break;
         case InstructionOpCode::CALL_BARRAY:
-            executeCallBarray();
+            executeCallBarray(instr);
+            break;
+        case pseudo_opcode::INVALID_JUMP:
+            executeInvalidJump(instr);
+            break;
+        case pseudo_opcode::END_OF_CODE:
+            executeEndOfCode();
+            break;
+        case super_opcode::LD_L_CONST:
+            executeLoadLocalValueConst(instr);
+            break;
+        case super_opcode::LD_A_CONST:
+            executeLoadArgumentValueConst(instr);
+            break;
+        case super_opcode::CONST_ADD:
+            executeConstAdd(instr);
+            break;
+        case super_opcode::CONST_SUB:
+            executeConstSub(instr);
+            break;
+        case super_opcode::LD_L_CJMPZ:
+            executeLoadLocalValueCjmpz(instr);
+            break;
+        case super_opcode::LD_A_CJMPZ:
+            executeLoadArgumentValueCjmpz(instr);
+            break;
+        case super_opcode::DUP_TAG:
+            executeDupTag();
+            break;
+        case super_opcode::ST_L_DROP:
+            executeStoreLocalValueDrop(instr);
+            break;
+        case quick_opcode::BINOP_ADD:
+        case quick_opcode::BINOP_SUB:
+        case quick_opcode::BINOP_MUL:
+        case quick_opcode::BINOP_DIV:
+        case quick_opcode::BINOP_MOD:
+        case quick_opcode::BINOP_LT:
+        case quick_opcode::BINOP_LE:
+        case quick_opcode::BINOP_GT:
+        case quick_opcode::BINOP_GE:
+        case quick_opcode::BINOP_EQ:
+        case quick_opcode::BINOP_NE:
+        case quick_opcode::BINOP_AND:
+        case quick_opcode::BINOP_OR:
+            executeIntBinop(quick_opcode::getBinopOpcode(op));
+            break;
+        case quick_opcode::CJMPZ:
+            executeIntConditionalJmpIfZero(instr);
+            break;
+        case quick_opcode::CJMPNZ:
+            executeIntConditionalJmpIfNotZero(instr);
             break;
         default:
             DO_IF_DYN_VER(interpreterAssert(false, "invalid instruction"));
@@ -1136,25 +1573,662 @@ void lama::interpreter::BytecodeInterpreterState::executeCurrentInstruction() {
     }
 }
 
-void lama::interpreter::interpretBytecodeFile(bytecode::BytecodeFile *file, VerificationMode mode) {
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::runSwitchDispatch() {
+    while (!isEndReached()) {
+        executeCurrentInstruction();
+    }
+}
+
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::runProfilingDispatch(ExecutionProfile &profile) {
+    instr_index_t prevIp = InstructionStream::NO_INDEX;
+
+    while (!isEndReached()) {
+        const instr_index_t ip = getIp();
+        const DecodedInstruction &instr = lookupInstruction(ip);
+
+        // pseudo instructions appended by the decoder do not belong to the code
+        if (instr.opcode != pseudo_opcode::INVALID_JUMP && instr.opcode != pseudo_opcode::END_OF_CODE) {
+            profile.countExecution(instr.offset);
+
+            if (prevIp != InstructionStream::NO_INDEX && ip == prevIp + 1) {
+                profile.countFallThrough(lookupInstruction(prevIp).offset);
+            }
+        }
+
+        prevIp = ip;
+
+        executeCurrentInstruction();
+    }
+}
+
+#ifdef LAMA_THREADED_DISPATCH
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::runThreadedDispatch() {
+    using lama::bytecode::InstructionOpCode;
+
+    if (isEndReached()) {
+        return;
+    }
+
+    /*
+     * Every handler ends with its own indirect jump to the handler of the next instruction,
+     * so there is neither a shared dispatch branch nor end-of-code check per instruction.
+     * The end of interpretation can be reached only after END or RET.
+     */
+    void *dispatchTable[256];
+    std::fill(std::begin(dispatchTable), std::end(dispatchTable), &&op_invalid);
+
+    #define SET_HANDLER(OP, LABEL) (dispatchTable[static_cast<unsigned char>(InstructionOpCode::OP)] = &&LABEL)
+
+    SET_HANDLER(BINOP_ADD, op_binop_add);
+    SET_HANDLER(BINOP_SUB, op_binop_sub);
+    SET_HANDLER(BINOP_MUL, op_binop_mul);
+    SET_HANDLER(BINOP_DIV, op_binop_div);
+    SET_HANDLER(BINOP_MOD, op_binop_mod);
+    SET_HANDLER(BINOP_LT, op_binop_lt);
+    SET_HANDLER(BINOP_LE, op_binop_le);
+    SET_HANDLER(BINOP_GT, op_binop_gt);
+    SET_HANDLER(BINOP_GE, op_binop_ge);
+    SET_HANDLER(BINOP_EQ, op_binop_eq);
+    SET_HANDLER(BINOP_NE, op_binop_ne);
+    SET_HANDLER(BINOP_AND, op_binop_and);
+    SET_HANDLER(BINOP_OR, op_binop_or);
+    SET_HANDLER(CONST, op_const);
+    SET_HANDLER(STRING, op_string);
+    SET_HANDLER(SEXP, op_sexp);
+    SET_HANDLER(STI, op_sti);
+    SET_HANDLER(STA, op_sta);
+    SET_HANDLER(JMP, op_jmp);
+    SET_HANDLER(END, op_end);
+    SET_HANDLER(RET, op_ret);
+    SET_HANDLER(DROP, op_drop);
+    SET_HANDLER(DUP, op_dup);
+    SET_HANDLER(SWAP, op_swap);
+    SET_HANDLER(ELEM, op_elem);
+    SET_HANDLER(LD_G, op_ld_g);
+    SET_HANDLER(LD_L, op_ld_l);
+    SET_HANDLER(LD_A, op_ld_a);
+    SET_HANDLER(LD_C, op_ld_c);
+    SET_HANDLER(LDA_G, op_lda_g);
+    SET_HANDLER(LDA_L, op_lda_l);
+    SET_HANDLER(LDA_A, op_lda_a);
+    SET_HANDLER(LDA_C, op_lda_c);
+    SET_HANDLER(ST_G, op_st_g);
+    SET_HANDLER(ST_L, op_st_l);
+    SET_HANDLER(ST_A, op_st_a);
+    SET_HANDLER(ST_C, op_st_c);
+    SET_HANDLER(CJMPZ, op_cjmpz);
+    SET_HANDLER(CJMPNZ, op_cjmpnz);
+    SET_HANDLER(BEGIN, op_begin);
+    SET_HANDLER(CBEGIN, op_cbegin);
+    SET_HANDLER(CLOSURE, op_closure);
+    SET_HANDLER(CALLC, op_callc);
+    SET_HANDLER(CALL, op_call);
+    SET_HANDLER(TAG, op_tag);
+    SET_HANDLER(ARRAY, op_array);
+    SET_HANDLER(FAIL, op_fail);
+    SET_HANDLER(LINE, op_line);
+    SET_HANDLER(PATT_STR, op_patt_str);
+    SET_HANDLER(PATT_STRING, op_patt_string);
+    SET_HANDLER(PATT_ARRAY, op_patt_array);
+    SET_HANDLER(PATT_SEXP, op_patt_sexp);
+    SET_HANDLER(PATT_REF, op_patt_ref);
+    SET_HANDLER(PATT_VAL, op_patt_val);
+    SET_HANDLER(PATT_FUN, op_patt_fun);
+    SET_HANDLER(CALL_LREAD, op_call_lread);
+    SET_HANDLER(CALL_LWRITE, op_call_lwrite);
+    SET_HANDLER(CALL_LLENGTH, op_call_llength);
+    SET_HANDLER(CALL_LSTRING, op_call_lstring);
+    SET_HANDLER(CALL_BARRAY, op_call_barray);
+
+    #undef SET_HANDLER
+
+    dispatchTable[static_cast<unsigned char>(pseudo_opcode::INVALID_JUMP)] = &&op_invalid_jump;
+    dispatchTable[static_cast<unsigned char>(pseudo_opcode::END_OF_CODE)] = &&op_end_of_code;
+    dispatchTable[static_cast<unsigned char>(pseudo_opcode::TAIL_CALLC)] = &&op_tail_callc;
+    dispatchTable[static_cast<unsigned char>(pseudo_opcode::TAIL_CALL)] = &&op_tail_call;
+    dispatchTable[static_cast<unsigned char>(pseudo_opcode::UNVERIFIED_BEGIN)] = &&op_unverified_begin;
+    dispatchTable[static_cast<unsigned char>(pseudo_opcode::UNVERIFIED_CBEGIN)] = &&op_unverified_begin;
+
+    dispatchTable[static_cast<unsigned char>(super_opcode::LD_L_CONST)] = &&op_ld_l_const;
+    dispatchTable[static_cast<unsigned char>(super_opcode::LD_A_CONST)] = &&op_ld_a_const;
+    dispatchTable[static_cast<unsigned char>(super_opcode::CONST_ADD)] = &&op_const_add;
+    dispatchTable[static_cast<unsigned char>(super_opcode::CONST_SUB)] = &&op_const_sub;
+    dispatchTable[static_cast<unsigned char>(super_opcode::LD_L_CJMPZ)] = &&op_ld_l_cjmpz;
+    dispatchTable[static_cast<unsigned char>(super_opcode::LD_A_CJMPZ)] = &&op_ld_a_cjmpz;
+    dispatchTable[static_cast<unsigned char>(super_opcode::DUP_TAG)] = &&op_dup_tag;
+    dispatchTable[static_cast<unsigned char>(super_opcode::ST_L_DROP)] = &&op_st_l_drop;
+
+    #define SET_QUICK_HANDLER(OP, LABEL) (dispatchTable[static_cast<unsigned char>(quick_opcode::OP)] = &&LABEL)
+
+    SET_QUICK_HANDLER(BINOP_ADD, op_int_binop_add);
+    SET_QUICK_HANDLER(BINOP_SUB, op_int_binop_sub);
+    SET_QUICK_HANDLER(BINOP_MUL, op_int_binop_mul);
+    SET_QUICK_HANDLER(BINOP_DIV, op_int_binop_div);
+    SET_QUICK_HANDLER(BINOP_MOD, op_int_binop_mod);
+    SET_QUICK_HANDLER(BINOP_LT, op_int_binop_lt);
+    SET_QUICK_HANDLER(BINOP_LE, op_int_binop_le);
+    SET_QUICK_HANDLER(BINOP_GT, op_int_binop_gt);
+    SET_QUICK_HANDLER(BINOP_GE, op_int_binop_ge);
+    SET_QUICK_HANDLER(BINOP_EQ, op_int_binop_eq);
+    SET_QUICK_HANDLER(BINOP_NE, op_int_binop_ne);
+    SET_QUICK_HANDLER(BINOP_AND, op_int_binop_and);
+    SET_QUICK_HANDLER(BINOP_OR, op_int_binop_or);
+    SET_QUICK_HANDLER(CJMPZ, op_int_cjmpz);
+    SET_QUICK_HANDLER(CJMPNZ, op_int_cjmpnz);
+
+    #undef SET_QUICK_HANDLER
+
+    #define DISPATCH() do {\
+        const InstructionOpCode op = fetchInstruction().opcode;\
+        DO_IF_DEBUG(std::cerr << "[interpreter-debug]: "\
+                  << "ip = " << std::hex << std::showbase << getInstructionStartOffset()\
+                  << ", op = " << static_cast<unsigned int>(op)\
+                  << std::dec << '\n');\
+        goto *dispatchTable[static_cast<unsigned char>(op)];\
+    } while (0)
+
+    #define HANDLER(LABEL, ACTION) LABEL: ACTION; DISPATCH()
+
+    DISPATCH();
+
+    HANDLER(op_binop_add, executeBinop(InstructionOpCode::BINOP_ADD));
+    HANDLER(op_binop_sub, executeBinop(InstructionOpCode::BINOP_SUB));
+    HANDLER(op_binop_mul, executeBinop(InstructionOpCode::BINOP_MUL));
+    HANDLER(op_binop_div, executeBinop(InstructionOpCode::BINOP_DIV));
+    HANDLER(op_binop_mod, executeBinop(InstructionOpCode::BINOP_MOD));
+    HANDLER(op_binop_lt, executeBinop(InstructionOpCode::BINOP_LT));
+    HANDLER(op_binop_le, executeBinop(InstructionOpCode::BINOP_LE));
+    HANDLER(op_binop_gt, executeBinop(InstructionOpCode::BINOP_GT));
+    HANDLER(op_binop_ge, executeBinop(InstructionOpCode::BINOP_GE));
+    HANDLER(op_binop_eq, executeBinop(InstructionOpCode::BINOP_EQ));
+    HANDLER(op_binop_ne, executeBinop(InstructionOpCode::BINOP_NE));
+    HANDLER(op_binop_and, executeBinop(InstructionOpCode::BINOP_AND));
+    HANDLER(op_binop_or, executeBinop(InstructionOpCode::BINOP_OR));
+    HANDLER(op_const, executeConst(*currentInstruction_));
+    HANDLER(op_string, executeString(*currentInstruction_));
+    HANDLER(op_sexp, executeSexp(*currentInstruction_));
+    HANDLER(op_sti, executeSti());
+    HANDLER(op_sta, executeSta(*currentInstruction_));
+    HANDLER(op_jmp, executeJmp(*currentInstruction_));
+    HANDLER(op_drop, executeDrop());
+    HANDLER(op_dup, executeDup());
+    HANDLER(op_swap, executeSwap());
+    HANDLER(op_elem, executeElem());
+    HANDLER(op_ld_g, executeLoadGlobalValue(*currentInstruction_));
+    HANDLER(op_ld_l, executeLoadLocalValue(*currentInstruction_));
+    HANDLER(op_ld_a, executeLoadArgumentValue(*currentInstruction_));
+    HANDLER(op_ld_c, executeLoadCapturedValue(*currentInstruction_));
+    HANDLER(op_lda_g, executeLoadGlobalValueAddress(*currentInstruction_));
+    HANDLER(op_lda_l, executeLoadLocalValueAddress(*currentInstruction_));
+    HANDLER(op_lda_a, executeLoadArgumentValueAddress(*currentInstruction_));
+    HANDLER(op_lda_c, executeLoadCapturedValueAddress(*currentInstruction_));
+    HANDLER(op_st_g, executeStoreGlobalValue(*currentInstruction_));
+    HANDLER(op_st_l, executeStoreLocalValue(*currentInstruction_));
+    HANDLER(op_st_a, executeStoreArgumentValue(*currentInstruction_));
+    HANDLER(op_st_c, executeStoreCapturedValue(*currentInstruction_));
+    HANDLER(op_cjmpz, executeConditionalJmpIfZero(*currentInstruction_));
+    HANDLER(op_cjmpnz, executeConditionalJmpIfNotZero(*currentInstruction_));
+    HANDLER(op_begin, executeBegin(*currentInstruction_));
+    HANDLER(op_cbegin, executeClosureBegin(*currentInstruction_));
+    HANDLER(op_closure, executeClosure(*currentInstruction_));
+    HANDLER(op_callc, executeCallClosure(*currentInstruction_));
+    HANDLER(op_call, executeCall(*currentInstruction_));
+    HANDLER(op_tag, executeTag(*currentInstruction_));
+    HANDLER(op_array, executeArray(*currentInstruction_));
+    HANDLER(op_fail, executeFail(*currentInstruction_));
+    HANDLER(op_line, executeLine(*currentInstruction_));
+    HANDLER(op_patt_str, executePattStr());
+    HANDLER(op_patt_string, executePattString());
+    HANDLER(op_patt_array, executePattArray());
+    HANDLER(op_patt_sexp, executePattSexp());
+    HANDLER(op_patt_ref, executePattRef());
+    HANDLER(op_patt_val, executePattVal());
+    HANDLER(op_patt_fun, executePattFun());
+    HANDLER(op_call_lread, executeCallLread());
+    HANDLER(op_call_lwrite, executeCallLwrite());
+    HANDLER(op_call_llength, executeCallLlength());
+    HANDLER(op_call_lstring, executeCallLstring());
+    HANDLER(op_call_barray, executeCallBarray(*currentInstruction_));
+    HANDLER(op_invalid_jump, executeInvalidJump(*currentInstruction_));
+    HANDLER(op_end_of_code, executeEndOfCode());
+    HANDLER(op_tail_callc, executeTailCallClosure(*currentInstruction_));
+    HANDLER(op_tail_call, executeTailCall(*currentInstruction_));
+    HANDLER(op_unverified_begin, executeUnverifiedBegin(*currentInstruction_));
+
+    HANDLER(op_ld_l_const, executeLoadLocalValueConst(*currentInstruction_));
+    HANDLER(op_ld_a_const, executeLoadArgumentValueConst(*currentInstruction_));
+    HANDLER(op_const_add, executeConstAdd(*currentInstruction_));
+    HANDLER(op_const_sub, executeConstSub(*currentInstruction_));
+    HANDLER(op_ld_l_cjmpz, executeLoadLocalValueCjmpz(*currentInstruction_));
+    HANDLER(op_ld_a_cjmpz, executeLoadArgumentValueCjmpz(*currentInstruction_));
+    HANDLER(op_dup_tag, executeDupTag());
+    HANDLER(op_st_l_drop, executeStoreLocalValueDrop(*currentInstruction_));
+
+    HANDLER(op_int_binop_add, executeIntBinop(InstructionOpCode::BINOP_ADD));
+    HANDLER(op_int_binop_sub, executeIntBinop(InstructionOpCode::BINOP_SUB));
+    HANDLER(op_int_binop_mul, executeIntBinop(InstructionOpCode::BINOP_MUL));
+    HANDLER(op_int_binop_div, executeIntBinop(InstructionOpCode::BINOP_DIV));
+    HANDLER(op_int_binop_mod, executeIntBinop(InstructionOpCode::BINOP_MOD));
+    HANDLER(op_int_binop_lt, executeIntBinop(InstructionOpCode::BINOP_LT));
+    HANDLER(op_int_binop_le, executeIntBinop(InstructionOpCode::BINOP_LE));
+    HANDLER(op_int_binop_gt, executeIntBinop(InstructionOpCode::BINOP_GT));
+    HANDLER(op_int_binop_ge, executeIntBinop(InstructionOpCode::BINOP_GE));
+    HANDLER(op_int_binop_eq, executeIntBinop(InstructionOpCode::BINOP_EQ));
+    HANDLER(op_int_binop_ne, executeIntBinop(InstructionOpCode::BINOP_NE));
+    HANDLER(op_int_binop_and, executeIntBinop(InstructionOpCode::BINOP_AND));
+    HANDLER(op_int_binop_or, executeIntBinop(InstructionOpCode::BINOP_OR));
+    HANDLER(op_int_cjmpz, executeIntConditionalJmpIfZero(*currentInstruction_));
+    HANDLER(op_int_cjmpnz, executeIntConditionalJmpIfNotZero(*currentInstruction_));
+
+    #undef HANDLER
+
+op_end:
+    executeEnd();
+    goto op_return_check;
+
+op_ret:
+    executeRet();
+    goto op_return_check;
+
+op_return_check:
+    if (callstack_.empty()) {
+        endReached_ = true;
+        return;
+    }
+
+    DISPATCH();
+
+op_invalid:
+    DO_IF_DYN_VER(interpreterAssert(false, "invalid instruction"));
+    DISPATCH();
+
+    #undef DISPATCH
+}
+#endif
+
+#ifdef LAMA_TOS_CACHING
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::runTosCachedDispatch() {
+    using lama::bytecode::InstructionOpCode;
+    using lama::interpreter::runtime::Value;
+
+    if (isEndReached()) {
+        return;
+    }
+
+    /*
+     * tos holds the topmost word of the operand stack, sp points past the topmost word kept in memory.
+     * Cached handlers do not update the operand stack, other instructions are executed
+     * by the generic handler, which spills tos to the operand stack beforehand, so the GC
+     * and the runtime always see the whole stack.
+     *
+     * Verified code never pops words below the locals of the current frame, hence tos
+     * may hold a copy of a local variable only while no instruction can store to it.
+     */
+    lama::runtime::Word *sp = stack_.end();
+    lama::runtime::Word tos = *--sp;
+
+    void *dispatchTable[256];
+    std::fill(std::begin(dispatchTable), std::end(dispatchTable), &&op_generic);
+
+    #define SET_HANDLER(OP, LABEL) (dispatchTable[static_cast<unsigned char>(OP)] = &&LABEL)
+
+    SET_HANDLER(InstructionOpCode::BINOP_ADD, op_binop_add);
+    SET_HANDLER(InstructionOpCode::BINOP_SUB, op_binop_sub);
+    SET_HANDLER(InstructionOpCode::BINOP_MUL, op_binop_mul);
+    SET_HANDLER(InstructionOpCode::BINOP_DIV, op_binop_div);
+    SET_HANDLER(InstructionOpCode::BINOP_MOD, op_binop_mod);
+    SET_HANDLER(InstructionOpCode::BINOP_LT, op_binop_lt);
+    SET_HANDLER(InstructionOpCode::BINOP_LE, op_binop_le);
+    SET_HANDLER(InstructionOpCode::BINOP_GT, op_binop_gt);
+    SET_HANDLER(InstructionOpCode::BINOP_GE, op_binop_ge);
+    SET_HANDLER(InstructionOpCode::BINOP_EQ, op_binop_eq);
+    SET_HANDLER(InstructionOpCode::BINOP_NE, op_binop_ne);
+    SET_HANDLER(InstructionOpCode::BINOP_AND, op_binop_and);
+    SET_HANDLER(InstructionOpCode::BINOP_OR, op_binop_or);
+    SET_HANDLER(InstructionOpCode::CONST, op_const);
+    SET_HANDLER(InstructionOpCode::JMP, op_jmp);
+    SET_HANDLER(InstructionOpCode::DROP, op_drop);
+    SET_HANDLER(InstructionOpCode::DUP, op_dup);
+    SET_HANDLER(InstructionOpCode::SWAP, op_swap);
+    SET_HANDLER(InstructionOpCode::LD_G, op_ld_g);
+    SET_HANDLER(InstructionOpCode::LD_L, op_ld_l);
+    SET_HANDLER(InstructionOpCode::LD_A, op_ld_a);
+    SET_HANDLER(InstructionOpCode::ST_G, op_st_g);
+    SET_HANDLER(InstructionOpCode::ST_L, op_st_l);
+    SET_HANDLER(InstructionOpCode::ST_A, op_st_a);
+    SET_HANDLER(InstructionOpCode::CJMPZ, op_cjmpz);
+    SET_HANDLER(InstructionOpCode::CJMPNZ, op_cjmpnz);
+    SET_HANDLER(InstructionOpCode::LINE, op_line);
+    SET_HANDLER(super_opcode::LD_L_CONST, op_ld_l_const);
+    SET_HANDLER(super_opcode::LD_A_CONST, op_ld_a_const);
+    SET_HANDLER(super_opcode::CONST_ADD, op_const_add);
+    SET_HANDLER(super_opcode::CONST_SUB, op_const_sub);
+    SET_HANDLER(super_opcode::LD_L_CJMPZ, op_ld_l_cjmpz);
+    SET_HANDLER(super_opcode::LD_A_CJMPZ, op_ld_a_cjmpz);
+    SET_HANDLER(super_opcode::ST_L_DROP, op_st_l_drop);
+    SET_HANDLER(quick_opcode::BINOP_ADD, op_int_binop_add);
+    SET_HANDLER(quick_opcode::BINOP_SUB, op_int_binop_sub);
+    SET_HANDLER(quick_opcode::BINOP_MUL, op_int_binop_mul);
+    SET_HANDLER(quick_opcode::BINOP_DIV, op_int_binop_div);
+    SET_HANDLER(quick_opcode::BINOP_MOD, op_int_binop_mod);
+    SET_HANDLER(quick_opcode::BINOP_LT, op_int_binop_lt);
+    SET_HANDLER(quick_opcode::BINOP_LE, op_int_binop_le);
+    SET_HANDLER(quick_opcode::BINOP_GT, op_int_binop_gt);
+    SET_HANDLER(quick_opcode::BINOP_GE, op_int_binop_ge);
+    SET_HANDLER(quick_opcode::BINOP_EQ, op_int_binop_eq);
+    SET_HANDLER(quick_opcode::BINOP_NE, op_int_binop_ne);
+    SET_HANDLER(quick_opcode::BINOP_AND, op_int_binop_and);
+    SET_HANDLER(quick_opcode::BINOP_OR, op_int_binop_or);
+    SET_HANDLER(quick_opcode::CJMPZ, op_int_cjmpz);
+    SET_HANDLER(quick_opcode::CJMPNZ, op_int_cjmpnz);
+
+    #undef SET_HANDLER
+
+    #define DISPATCH() do {\
+        const InstructionOpCode op = fetchInstruction().opcode;\
+        goto *dispatchTable[static_cast<unsigned char>(op)];\
+    } while (0)
+
+    #define HANDLER(LABEL, ACTION) LABEL: { ACTION; } DISPATCH()
+
+    #define TOS_PUSH(W) do {\
+        *sp++ = tos;\
+        tos = (W);\
+    } while (0)
+
+    #define TOS_POP_INT(VAR) \
+        const Value VAR{tos};\
+        interpreterAssert(VAR.isInt(), "expected an integer");\
+        tos = *--sp
+
+    #define ARITH_HANDLER(LABEL, OP) HANDLER(LABEL, \
+        const Value y{tos};\
+        interpreterAssert(y.isInt(), "expected an integer");\
+        const Value x{*--sp};\
+        interpreterAssert(x.isInt(), "expected an integer");\
+        tos = Value{computeArithBinop(InstructionOpCode::OP, x.getNativeInt(), y.getNativeInt())}.getRawWord())
+
+    #define COMPARISON_HANDLER(LABEL, OP) HANDLER(LABEL, \
+        const Value y{tos};\
+        interpreterAssert(y.isInt(), "expected an integer");\
+        const Value x{*--sp};\
+        interpreterAssert(x.isInt(), "expected an integer");\
+        tos = Value{computeComparisonBinop(InstructionOpCode::OP, x.getNativeInt(), y.getNativeInt())}.getRawWord())
+
+    #define LOGICAL_HANDLER(LABEL, OPERATOR) HANDLER(LABEL, \
+        const Value y{tos};\
+        interpreterAssert(y.isInt(), "expected an integer");\
+        const Value x{*--sp};\
+        interpreterAssert(x.isInt(), "expected an integer");\
+        tos = Value{static_cast<bool>(x.getNativeInt() OPERATOR y.getNativeInt())}.getRawWord())
+
+    #define INT_BINOP_HANDLER(LABEL, OP) HANDLER(LABEL, \
+        const Value y{tos};\
+        const Value x{*--sp};\
+        tos = computeIntBinop(InstructionOpCode::OP, x.getNativeInt(), y.getNativeInt()))
+
+    DISPATCH();
+
+    ARITH_HANDLER(op_binop_add, BINOP_ADD);
+    ARITH_HANDLER(op_binop_sub, BINOP_SUB);
+    ARITH_HANDLER(op_binop_mul, BINOP_MUL);
+    ARITH_HANDLER(op_binop_div, BINOP_DIV);
+    ARITH_HANDLER(op_binop_mod, BINOP_MOD);
+    COMPARISON_HANDLER(op_binop_lt, BINOP_LT);
+    COMPARISON_HANDLER(op_binop_le, BINOP_LE);
+    COMPARISON_HANDLER(op_binop_gt, BINOP_GT);
+    COMPARISON_HANDLER(op_binop_ge, BINOP_GE);
+    COMPARISON_HANDLER(op_binop_ne, BINOP_NE);
+    LOGICAL_HANDLER(op_binop_and, &&);
+    LOGICAL_HANDLER(op_binop_or, ||);
+
+    HANDLER(op_binop_eq,
+        const Value y{tos};
+        const Value x{*--sp};
+        tos = Value{computeEquality(x, y)}.getRawWord());
+
+    HANDLER(op_const, TOS_PUSH(lama::runtime::Word(currentInstruction_->operand0)));
+    HANDLER(op_jmp, setIp(currentInstruction_->operand0));
+    HANDLER(op_drop, tos = *--sp);
+    HANDLER(op_dup, *sp++ = tos);
+    HANDLER(op_swap, std::swap(tos, sp[-1]));
+    HANDLER(op_ld_g, TOS_PUSH(getGlobalValue(currentInstruction_->operand0)));
+    HANDLER(op_ld_l, TOS_PUSH(getLocalValue(currentInstruction_->operand0)));
+    HANDLER(op_ld_a, TOS_PUSH(getArgumentValue(currentInstruction_->operand0)));
+    HANDLER(op_st_g, setGlobalValue(currentInstruction_->operand0, tos));
+    HANDLER(op_st_l, setLocalValue(currentInstruction_->operand0, tos));
+    HANDLER(op_st_a, setArgumentValue(currentInstruction_->operand0, tos));
+    HANDLER(op_line, );
+
+    HANDLER(op_cjmpz,
+        TOS_POP_INT(val);
+
+        if (val.getNativeInt() == 0) {
+            setIp(currentInstruction_->operand0);
+        });
+
+    HANDLER(op_cjmpnz,
+        TOS_POP_INT(val);
+
+        if (val.getNativeInt() != 0) {
+            setIp(currentInstruction_->operand0);
+        });
+
+    HANDLER(op_ld_l_const,
+        TOS_PUSH(getLocalValue(currentInstruction_->operand0));
+        TOS_PUSH(lama::runtime::Word(fetchInstruction().operand0)));
+
+    HANDLER(op_ld_a_const,
+        TOS_PUSH(getArgumentValue(currentInstruction_->operand0));
+        TOS_PUSH(lama::runtime::Word(fetchInstruction().operand0)));
+
+    HANDLER(op_const_add,
+        const Value y{lama::runtime::Word(currentInstruction_->operand0)};
+        fetchInstruction();
+        const Value x{tos};
+        interpreterAssert(x.isInt(), "expected an integer");
+        tos = Value{lama::runtime::native_int_t{x.getNativeInt() + y.getNativeInt()}}.getRawWord());
+
+    HANDLER(op_const_sub,
+        const Value y{lama::runtime::Word(currentInstruction_->operand0)};
+        fetchInstruction();
+        const Value x{tos};
+        interpreterAssert(x.isInt(), "expected an integer");
+        tos = Value{lama::runtime::native_int_t{x.getNativeInt() - y.getNativeInt()}}.getRawWord());
+
+    HANDLER(op_ld_l_cjmpz,
+        const Value val{getLocalValue(currentInstruction_->operand0)};
+        const instr_index_t target = fetchInstruction().operand0;
+        interpreterAssert(val.isInt(), "expected an integer");
+
+        if (val.getNativeInt() == 0) {
+            setIp(target);
+        });
+
+    HANDLER(op_ld_a_cjmpz,
+        const Value val{getArgumentValue(currentInstruction_->operand0)};
+        const instr_index_t target = fetchInstruction().operand0;
+        interpreterAssert(val.isInt(), "expected an integer");
+
+        if (val.getNativeInt() == 0) {
+            setIp(target);
+        });
+
+    HANDLER(op_st_l_drop,
+        setLocalValue(currentInstruction_->operand0, tos);
+        tos = *--sp;
+        fetchInstruction());
+
+    INT_BINOP_HANDLER(op_int_binop_add, BINOP_ADD);
+    INT_BINOP_HANDLER(op_int_binop_sub, BINOP_SUB);
+    INT_BINOP_HANDLER(op_int_binop_mul, BINOP_MUL);
+    INT_BINOP_HANDLER(op_int_binop_div, BINOP_DIV);
+    INT_BINOP_HANDLER(op_int_binop_mod, BINOP_MOD);
+    INT_BINOP_HANDLER(op_int_binop_lt, BINOP_LT);
+    INT_BINOP_HANDLER(op_int_binop_le, BINOP_LE);
+    INT_BINOP_HANDLER(op_int_binop_gt, BINOP_GT);
+    INT_BINOP_HANDLER(op_int_binop_ge, BINOP_GE);
+    INT_BINOP_HANDLER(op_int_binop_eq, BINOP_EQ);
+    INT_BINOP_HANDLER(op_int_binop_ne, BINOP_NE);
+    INT_BINOP_HANDLER(op_int_binop_and, BINOP_AND);
+    INT_BINOP_HANDLER(op_int_binop_or, BINOP_OR);
+
+    HANDLER(op_int_cjmpz,
+        const Value val{tos};
+        tos = *--sp;
+
+        if (val.getNativeInt() == 0) {
+            setIp(currentInstruction_->operand0);
+        });
+
+    HANDLER(op_int_cjmpnz,
+        const Value val{tos};
+        tos = *--sp;
+
+        if (val.getNativeInt() != 0) {
+            setIp(currentInstruction_->operand0);
+        });
+
+    #undef INT_BINOP_HANDLER
+    #undef LOGICAL_HANDLER
+    #undef COMPARISON_HANDLER
+    #undef ARITH_HANDLER
+    #undef TOS_POP_INT
+    #undef TOS_PUSH
+    #undef HANDLER
+
+op_generic:
+    *sp++ = tos;
+    stack_.setEnd(sp);
+
+    executeInstruction(*currentInstruction_);
+
+    if (isEndReached()) {
+        return;
+    }
+
+    sp = stack_.end();
+    tos = *--sp;
+
+    DISPATCH();
+
+    #undef DISPATCH
+}
+#endif
+
+template<lama::interpreter::VerificationMode Mode>
+void lama::interpreter::BytecodeInterpreterState<Mode>::run() {
+#ifdef LAMA_TOS_CACHING
+    if constexpr (!DYNAMIC_CHECKS) {
+        runTosCachedDispatch();
+    } else {
+        runThreadedDispatch();
+    }
+#elif defined(LAMA_THREADED_DISPATCH)
+    runThreadedDispatch();
+#else
+    runSwitchDispatch();
+#endif
+}
+
+template class lama::interpreter::BytecodeInterpreterState<lama::interpreter::VerificationMode::STATIC_VERIFICATION>;
+template class lama::interpreter::BytecodeInterpreterState<lama::interpreter::VerificationMode::DYNAMIC_VERIFICATION>;
+
+namespace {
+template<lama::interpreter::VerificationMode Mode>
+void runInterpreter(
+    const lama::bytecode::BytecodeFile *file,
+    const lama::interpreter::InstructionStream *code,
+    lama::verifier::LazyVerifier *lazyVerifier = nullptr,
+    lama::interpreter::ExecutionProfile *profile = nullptr
+) {
+    lama::interpreter::BytecodeInterpreterState<Mode> state{file, code, lazyVerifier};
+
+    if (profile != nullptr) {
+        state.runProfilingDispatch(*profile);
+    } else {
+        state.run();
+    }
+}
+
+bool hasStaInstructions(const lama::interpreter::InstructionStream &code) {
+    for (std::size_t i = 0; i < code.size(); ++i) {
+        if (code[i].opcode == lama::bytecode::InstructionOpCode::STA) {
+            return true;
+        }
+    }
+
+    return false;
+}
+}
+
+void lama::interpreter::interpretBytecodeFile(
+    const bytecode::BytecodeFile *file,
+    VerificationMode mode,
+    const SuperinstructionSet &superinstructions,
+    ExecutionEngine engine,
+    bool useVerificationCache,
+    bool lazyVerification,
+    ExecutionProfile *profile
+) {
     ::__init();
 
+    // a fused pair is a single instruction of the decoded code, so it could not be counted
+    const SuperinstructionSet usedSuperinstructions = profile != nullptr ? SuperinstructionSet{} : superinstructions;
+
+    /*
+     * Native code is compiled from the whole verified code in advance, so lazy verification
+     * is used by the interpreter only
+     */
+    if (mode == VerificationMode::STATIC_VERIFICATION && lazyVerification && engine == ExecutionEngine::INTERPRETER) {
+        InstructionStream code = decodeBytecodeFile(file, usedSuperinstructions, VerificationResult{}, true);
+
+        // an STA with a destination of unknown type makes the whole file unverifiable, so it is found out in advance
+        if (!hasStaInstructions(code)) {
+            lama::verifier::LazyVerifier verifier{file, &code};
+            verifier.verifyEntryFunction();
+
+            runInterpreter<VerificationMode::STATIC_VERIFICATION>(file, &code, &verifier, profile);
+
+            ::__shutdown();
+
+            return;
+        }
+    }
+
     /*
      * A verifier tries statically check the bytecode file.
-     * If verifier meets problematic instructions (e.g. STA), verification won't be finished.
-     * Incomplete static verification is not an obstacle, we can enable dynamic checks.
-     * Even though the verifier may have changed some bytes, interpretation will work as usual,
-     * a number of local variables will be read from 2 lower bytes of second parameter of
-     * [C]BEGIN bytecode instruction
+     * If the verification cannot be finished, it is not an obstacle, we can enable dynamic checks.
+     * The verifier never modifies the code, its result (frame stack sizes, type facts) is passed to the decoder.
+     * The cached result is indistinguishable from a fresh one
      */
-    if (mode == VerificationMode::STATIC_VERIFICATION && !lama::verifier::verifyBytecodeFile(file)) {
-        mode = VerificationMode::DYNAMIC_VERIFICATION;
+    VerificationResult verification;
+
+    if (mode == VerificationMode::STATIC_VERIFICATION) {
+        const bool verified = useVerificationCache
+            ? lama::verifier::verifyBytecodeFileCached(file, &verification)
+            : lama::verifier::verifyBytecodeFile(file, &verification);
+
+        if (!verified) {
+            mode = VerificationMode::DYNAMIC_VERIFICATION;
+        }
     }
 
-    BytecodeInterpreterState state{file, mode};
+    const InstructionStream code = decodeBytecodeFile(file, usedSuperinstructions, verification);
 
-    while (!state.isEndReached()) {
-        state.executeCurrentInstruction();
+    switch (mode) {
+        case VerificationMode::STATIC_VERIFICATION:
+            if (profile != nullptr || engine != ExecutionEngine::NATIVE_CODE || !lama::jit::runNativeCode(file, &code)) {
+                runInterpreter<VerificationMode::STATIC_VERIFICATION>(file, &code, nullptr, profile);
+            }
+            break;
+        case VerificationMode::DYNAMIC_VERIFICATION:
+            runInterpreter<VerificationMode::DYNAMIC_VERIFICATION>(file, &code, nullptr, profile);
+            break;
     }
 
     ::__shutdown();
@@ -3,13 +3,21 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <vector>
 
 #include "../bytecode/source_file.hpp"
 #include "../bytecode/bytecode_instructions.hpp"
+#include "execution_profile.hpp"
+#include "instruction_stream.hpp"
+#include "superinstructions.hpp"
 #include "interpreter_runtime.hpp"
 
 #include "lama_runtime.hpp"
 
+namespace lama::verifier {
+class LazyVerifier;
+}
+
 namespace lama::interpreter {
 #ifndef LAMA_CALL_STACK_CAPACITY
 #define LAMA_CALL_STACK_CAPACITY 0xffff
@@ -17,14 +25,37 @@ namespace lama::interpreter {
 
 constexpr std::size_t CALLSTACK_CAPACITY = LAMA_CALL_STACK_CAPACITY;
 
+/*
+ * Threaded dispatch relies on the "labels as values" extension (computed goto),
+ * which is supported by GCC and Clang. Define LAMA_SWITCH_DISPATCH to fall back
+ * to the portable switch-based dispatch loop.
+ */
+#if !defined(LAMA_SWITCH_DISPATCH) && defined(__GNUC__)
+#define LAMA_THREADED_DISPATCH
+#endif
+
+/*
+ * Top-of-stack caching keeps the topmost operand stack word in a local variable
+ * of the threaded dispatch loop, the operand stack is synchronized only around
+ * instructions which may call the runtime (allocations, calls, patterns, etc.).
+ * The mode is used for statically verified bytecode only and it is disabled in debug builds.
+ * Define LAMA_NO_TOS_CACHING to disable it.
+ */
+#if defined(LAMA_THREADED_DISPATCH) && !defined(LAMA_NO_TOS_CACHING) && !defined(INTERPRETER_DEBUG)
+#define LAMA_TOS_CACHING
+#endif
+
+/*
+ * A callstack record is packed into two words: the frame base pointer,
+ * the arguments count and the locals count with the frame flags
+ */
 class CallstackFrame final {
 public:
     CallstackFrame() = default;
 
     CallstackFrame(lama::runtime::Word *frameBase,
-        std::size_t
-        argsCount,
-        std::size_t localsCount,
+        std::uint32_t argsCount,
+        std::uint32_t localsCount,
         bool hasClosure,
         bool hasCaptures
     )   : frameBase_(frameBase)
@@ -53,14 +84,6 @@ public:
         return getArgumentsStartAddress() + i;
     }
 
-    void setArgumentValue(lama::bytecode::offset_t i, lama::runtime::Word value) {
-        *getArgumentValueAddress(i) = value;
-    }
-
-    lama::runtime::Word getArgumentValue(lama::bytecode::offset_t i) const {
-        return *getArgumentValueAddress(i);
-    }
-
     lama::runtime::Word* getLocalValueAddress(lama::bytecode::offset_t i) {
         return getLocalsStartAddress() + i;
     }
@@ -69,25 +92,6 @@ public:
         return getLocalsStartAddress() + i;
     }
 
-    void setLocalValue(lama::bytecode::offset_t i, lama::runtime::Word value) {
-        *getLocalValueAddress(i) = value;
-    }
-
-    lama::runtime::Word getLocalValue(lama::bytecode::offset_t i) const {
-        return *getLocalValueAddress(i);
-    }
-
-    lama::runtime::Word* getCapturedValueAddress(lama::bytecode::offset_t i);
-    const lama::runtime::Word* getCapturedValueAddress(lama::bytecode::offset_t i) const;
-
-    void setCapturedValue(lama::bytecode::offset_t i, lama::runtime::Word value) {
-        *getCapturedValueAddress(i) = value;
-    }
-
-    lama::runtime::Word getCapturedValue(lama::bytecode::offset_t i) const {
-        return *getCapturedValueAddress(i);
-    }
-
     std::uint32_t getArgumentsCount() const {
         return argsCount_;
     }
@@ -107,10 +111,10 @@ public:
     }
 private:
     lama::runtime::Word *frameBase_;
-    std::size_t argsCount_;
-    std::size_t localsCount_;
-    bool hasClosure_;
-    bool hasCaptures_;
+    std::uint32_t argsCount_;
+    std::uint32_t localsCount_ : 30;
+    std::uint32_t hasClosure_ : 1;
+    std::uint32_t hasCaptures_ : 1;
 
     lama::runtime::Word* getLocalsStartAddress();
     const lama::runtime::Word* getLocalsStartAddress() const;
@@ -118,10 +122,11 @@ private:
     lama::runtime::Word* getArgumentsStartAddress();
     const lama::runtime::Word* getArgumentsStartAddress() const;
 
-    lama::runtime::Word* getCapturedContentAddress();
     const lama::runtime::Word* getCapturedContentAddress() const;
 };
 
+static_assert(sizeof(CallstackFrame) == sizeof(lama::runtime::Word *) + 2 * sizeof(std::uint32_t));
+
 namespace utils {
 class CallStack {
 public:
@@ -185,28 +190,53 @@ constexpr std::size_t OP_STACK_CAPACITY = LAMA_OP_STACK_CAPACITY;
 extern template class lama::interpreter::runtime::GcDataStack<lama::runtime::Word, OP_STACK_CAPACITY>;
 using DataStack = lama::interpreter::runtime::GcDataStack<lama::runtime::Word, OP_STACK_CAPACITY>;
 
+/*
+ * Monomorphic inline cache of a CALLC instruction, keyed by the code offset of the called closure.
+ * It is filled when the callee starts with valid BEGIN or CBEGIN, so a cache hit enters
+ * the function body directly
+ */
+struct CallSiteCache {
+    static constexpr std::int32_t EMPTY = -1;
+
+    std::int32_t codeOffset = EMPTY;
+    instr_index_t beginIndex = InstructionStream::NO_INDEX;
+    std::uint32_t argsNum = 0;
+    std::uint32_t localsNum = 0;
+    std::uint32_t frameStackSize = 0;
+    bool hasCaptures = false;
+};
+
 enum class VerificationMode {
     STATIC_VERIFICATION,
     DYNAMIC_VERIFICATION,
 };
 
+/*
+ * The interpreter is specialized on verification mode at compile time,
+ * so statically verified code runs without any residual checks of the mode
+ */
+template<VerificationMode Mode>
 class BytecodeInterpreterState {
 public:
+    static constexpr bool DYNAMIC_CHECKS = Mode == VerificationMode::DYNAMIC_VERIFICATION;
+
+    /* The lazy verifier is required if the code has unverified functions */
     BytecodeInterpreterState(
         const lama::bytecode::BytecodeFile *bytecodeFile,
-        VerificationMode mode = VerificationMode::DYNAMIC_VERIFICATION
+        const InstructionStream *code,
+        lama::verifier::LazyVerifier *lazyVerifier = nullptr
     );
 
     ~BytecodeInterpreterState() {
 
     }
 
-    lama::bytecode::offset_t getIp() const {
+    instr_index_t getIp() const {
         return ip_;
     }
 
     lama::bytecode::offset_t getInstructionStartOffset() const {
-        return instructionStartOffset_;
+        return currentInstruction_->offset;
     }
 
     bool isEndReached() const {
@@ -214,71 +244,65 @@ public:
     }
 
     void executeCurrentInstruction();
-protected:
-    std::byte lookupByte(lama::bytecode::offset_t pos) const {
-        if (mode_ == VerificationMode::DYNAMIC_VERIFICATION) {
-            interpreterAssert(pos < bytecodeFile_->getCodeSize(), "code offset out of range");
-        }
 
-        return bytecodeFile_->getCodeByte(pos);
-    }
+    void runSwitchDispatch();
+    /* Same as the switch dispatch, but every executed instruction and fall-through is counted in the profile */
+    void runProfilingDispatch(ExecutionProfile &profile);
+#ifdef LAMA_THREADED_DISPATCH
+    void runThreadedDispatch();
+#endif
+#ifdef LAMA_TOS_CACHING
+    void runTosCachedDispatch();
+#endif
 
-    std::byte lookupByte() const {
-        return lookupByte(getIp());
+    void run();
+protected:
+    void setIp(instr_index_t newIp) {
+        ip_ = newIp;
     }
 
-    lama::bytecode::InstructionOpCode lookupInstrOpCode(lama::bytecode::offset_t pos) const {
-        return lama::bytecode::InstructionOpCode{static_cast<unsigned char>(lookupByte(pos))};
+    void advanceIp(instr_index_t offset = 1) {
+        ip_ += offset;
     }
 
-    lama::bytecode::InstructionOpCode lookupInstrOpCode() const {
-        return lookupInstrOpCode(getIp());
+    const DecodedInstruction& lookupInstruction(instr_index_t index) const {
+        return instructions_[index];
     }
 
-    std::byte fetchByte() {
-        std::byte val = lookupByte();
-        advanceIp(sizeof(val));
+    const DecodedInstruction& fetchInstruction() {
+        currentInstruction_ = &lookupInstruction(getIp());
+        advanceIp();
 
-        return val;
+        return *currentInstruction_;
     }
 
-    lama::bytecode::InstructionOpCode fetchInstrOpCode() {
-        return lama::bytecode::InstructionOpCode{static_cast<unsigned char>(fetchByte())};
-    }
+    instr_index_t getInstructionIndex(lama::bytecode::offset_t offset) const {
+        checkCodeOffset(offset);
 
-    std::int32_t lookupInt32(lama::bytecode::offset_t pos) const {
-        std::int32_t val;
+        const instr_index_t index = code_->getInstructionIndex(offset);
+        interpreterAssert(index != InstructionStream::NO_INDEX, "jump target is not an instruction");
 
-        if (mode_ == VerificationMode::DYNAMIC_VERIFICATION) {
-            interpreterAssert(pos + sizeof(val) <= bytecodeFile_->getCodeSize(), "code offset out of range");
-        }
-
-        bytecodeFile_->copyCodeBytes(static_cast<std::byte *>(static_cast<void *>(&val)), pos, sizeof(val));
-
-        return val;
+        return index;
     }
 
-    std::int32_t lookupInt32() const {
-        return lookupInt32(getIp());
-    }
-
-    std::int32_t fetchInt32() {
-        std::int32_t val = lookupInt32();
-        advanceIp(sizeof(val));
+    std::string_view getString(const DecodedInstruction &instr) const {
+        if constexpr (DYNAMIC_CHECKS) {
+            interpreterAssert(instr.string != nullptr, "string table index is out of range");
+        }
 
-        return val;
+        return instr.string;
     }
 
-    std::string_view getString(lama::bytecode::offset_t index) const {
-        if (mode_ == VerificationMode::DYNAMIC_VERIFICATION) {
-            interpreterAssert(index < bytecodeFile_->getStringTableSize(), "string table index is out of range");
+    lama::runtime::native_int_t getTagHash(const DecodedInstruction &instr) const {
+        if (instr.operand0 != 0) {
+            return instr.operand0;
         }
 
-        return bytecodeFile_->getString(index);
+        return ::LtagHash(const_cast<char *>(getString(instr).data()));
     }
 
     void pushWord(lama::runtime::Word w) {
-        if (mode_ == VerificationMode::DYNAMIC_VERIFICATION) {
+        if constexpr (DYNAMIC_CHECKS) {
             checkStackOverflow(stack_.size());
         }
 
@@ -286,7 +310,7 @@ protected:
     }
 
     lama::runtime::Word peekWord(std::size_t offset = 1) const {
-        if (mode_ == VerificationMode::DYNAMIC_VERIFICATION) {
+        if constexpr (DYNAMIC_CHECKS) {
             interpreterAssert(stack_.size() >= offset, "operand stack index overflow while peeking Lama Word");
         }
 
@@ -294,7 +318,7 @@ protected:
     }
 
     lama::runtime::Word *peekWordAddress(std::size_t offset = 1) {
-        if (mode_ == VerificationMode::DYNAMIC_VERIFICATION) {
+        if constexpr (DYNAMIC_CHECKS) {
             interpreterAssert(stack_.size() >= offset, "operand stack index overflow while peeking Lama Word addr");
         }
 
@@ -302,7 +326,7 @@ protected:
     }
 
     const lama::runtime::Word *peekWordAddress(std::size_t offset = 1) const {
-        if (mode_ == VerificationMode::DYNAMIC_VERIFICATION) {
+        if constexpr (DYNAMIC_CHECKS) {
             interpreterAssert(stack_.size() >= offset, "operand stack index overflow while peeking Lama Word addr");
         }
 
@@ -310,7 +334,7 @@ protected:
     }
 
     lama::interpreter::runtime::Value peekValue(std::size_t offset = 1) const {
-        if (mode_ == VerificationMode::DYNAMIC_VERIFICATION) {
+        if constexpr (DYNAMIC_CHECKS) {
             interpreterAssert(stack_.size() >= offset, "operand stack index overflow while peeking Lama Value");
         }
 
@@ -318,7 +342,7 @@ protected:
     }
 
     lama::runtime::Word popWord() {
-        if (mode_ == VerificationMode::DYNAMIC_VERIFICATION) {
+        if constexpr (DYNAMIC_CHECKS) {
             interpreterAssert(stack_.nonEmpty(), "operand stack is empty");
         }
 
@@ -382,25 +406,75 @@ protected:
     void pushFrame(const CallstackFrame &frame) {
         interpreterAssert(callstack_.size() < callstack_.capacity, "callstack exhausted");
         callstack_.push(frame);
+        updateFrameBases();
     }
 
-    void pushFrame(CallstackFrame&& frame) {
-        interpreterAssert(callstack_.size() < callstack_.capacity, "callstack exhausted");
-        callstack_.push(std::move(frame));
+    bool hasFrames() const {
+        return callstack_.nonEmpty();
     }
 
-    CallstackFrame peekFrame() const {
+    const CallstackFrame& peekFrame() const {
         interpreterAssert(callstack_.nonEmpty(), "callstack is empty");
-        return callstack_.peek();
+        return *callstack_.peekAddress();
     }
 
     CallstackFrame popFrame() {
         const CallstackFrame top = peekFrame();
         callstack_.pop();
 
+        if (callstack_.nonEmpty()) {
+            updateFrameBases();
+        }
+
         return top;
     }
 
+    lama::runtime::Word* getLocalValueAddress(lama::bytecode::offset_t i) {
+        checkLocalValueIndex(i);
+
+        return localsBase_ + i;
+    }
+
+    void setLocalValue(lama::bytecode::offset_t i, lama::runtime::Word value) {
+        *getLocalValueAddress(i) = value;
+    }
+
+    lama::runtime::Word getLocalValue(lama::bytecode::offset_t i) {
+        return *getLocalValueAddress(i);
+    }
+
+    lama::runtime::Word* getArgumentValueAddress(lama::bytecode::offset_t i) {
+        checkArgumentValueIndex(i);
+
+        return argumentsBase_ + i;
+    }
+
+    void setArgumentValue(lama::bytecode::offset_t i, lama::runtime::Word value) {
+        *getArgumentValueAddress(i) = value;
+    }
+
+    lama::runtime::Word getArgumentValue(lama::bytecode::offset_t i) {
+        return *getArgumentValueAddress(i);
+    }
+
+    /*
+     * Unlike the bases of locals and arguments, the captures base is not cached: any allocation may compact
+     * the heap and move the closure, so it is read from its slot below the arguments on every access
+     */
+    lama::runtime::Word* getCapturedValueAddress(lama::bytecode::offset_t i) {
+        checkCapturedValueIndex(i);
+
+        return reinterpret_cast<lama::runtime::Word *>(argumentsBase_[-1]) + i + 1;
+    }
+
+    void setCapturedValue(lama::bytecode::offset_t i, lama::runtime::Word value) {
+        *getCapturedValueAddress(i) = value;
+    }
+
+    lama::runtime::Word getCapturedValue(lama::bytecode::offset_t i) {
+        return *getCapturedValueAddress(i);
+    }
+
     lama::runtime::Word* getGlobalValueAddress(lama::bytecode::offset_t i) {
         checkGlobalValueIndex(i);
 
@@ -422,26 +496,34 @@ protected:
     }
 
     void interpreterAssert(bool condition, std::string_view message) const {
-        if (!condition) {
-            ::failure(
-                const_cast<char *>("internal error (file: %s, code offset: %" PRIdAI "): %s\n"),
-                bytecodeFile_->getFilePath().data(),
-                getInstructionStartOffset(),
-                message.data()
-             );
+        if (!condition) [[unlikely]] {
+            reportInternalError(message);
         }
     }
 
+    /* Kept out of line, so that checks on the hot path stay small enough to be inlined */
+    [[noreturn, gnu::noinline, gnu::cold]] void reportInternalError(std::string_view message) const {
+        ::failure(
+            const_cast<char *>("internal error (file: %s, code offset: %" PRIdAI "): %s\n"),
+            bytecodeFile_->getFilePath().data(),
+            getInstructionStartOffset(),
+            message.data()
+         );
+    }
+
+    void executeInstruction(const DecodedInstruction &instr);
+
     void executeBinop(lama::bytecode::InstructionOpCode opcode);
+    void executeIntBinop(lama::bytecode::InstructionOpCode opcode);
 
-    void executeConst();
-    void executeString();
-    void executeSexp();
+    void executeConst(const DecodedInstruction &instr);
+    void executeString(const DecodedInstruction &instr);
+    void executeSexp(const DecodedInstruction &instr);
 
     void executeSti();
-    void executeSta();
+    void executeSta(const DecodedInstruction &instr);
 
-    void executeJmp();
+    void executeJmp(const DecodedInstruction &instr);
 
     void executeEnd();
     void executeRet();
@@ -452,36 +534,42 @@ protected:
 
     void executeElem();
 
-    void executeLoadGlobalValue();
-    void executeLoadLocalValue();
-    void executeLoadArgumentValue();
-    void executeLoadCapturedValue();
+    void executeLoadGlobalValue(const DecodedInstruction &instr);
+    void executeLoadLocalValue(const DecodedInstruction &instr);
+    void executeLoadArgumentValue(const DecodedInstruction &instr);
+    void executeLoadCapturedValue(const DecodedInstruction &instr);
 
-    void executeLoadGlobalValueAddress();
-    void executeLoadLocalValueAddress();
-    void executeLoadArgumentValueAddress();
-    void executeLoadCapturedValueAddress();
+    void executeLoadGlobalValueAddress(const DecodedInstruction &instr);
+    void executeLoadLocalValueAddress(const DecodedInstruction &instr);
+    void executeLoadArgumentValueAddress(const DecodedInstruction &instr);
+    void executeLoadCapturedValueAddress(const DecodedInstruction &instr);
 
-    void executeStoreGlobalValue();
-    void executeStoreLocalValue();
-    void executeStoreArgumentValue();
-    void executeStoreCapturedValue();
+    void executeStoreGlobalValue(const DecodedInstruction &instr);
+    void executeStoreLocalValue(const DecodedInstruction &instr);
+    void executeStoreArgumentValue(const DecodedInstruction &instr);
+    void executeStoreCapturedValue(const DecodedInstruction &instr);
 
-    void executeConditionalJmpIfZero();
-    void executeConditionalJmpIfNotZero();
+    void executeConditionalJmpIfZero(const DecodedInstruction &instr);
+    void executeConditionalJmpIfNotZero(const DecodedInstruction &instr);
+    void executeIntConditionalJmpIfZero(const DecodedInstruction &instr);
+    void executeIntConditionalJmpIfNotZero(const DecodedInstruction &instr);
 
-    void executeBegin();
-    void executeClosureBegin();
+    void executeBegin(const DecodedInstruction &instr);
+    void executeClosureBegin(const DecodedInstruction &instr);
 
-    void processFunctionBegin(std::size_t argsNum, std::size_t localsNum, bool isClosure);
+    void executeUnverifiedBegin(const DecodedInstruction &instr);
 
-    void executeClosure();
-    void executeCallClosure();
-    void executeCall();
-    void executeTag();
-    void executeArray();
-    void executeFail();
-    void executeLine();
+    void processFunctionBegin(std::uint32_t argsNum, std::uint32_t localsNum, bool hasCaptures);
+
+    void executeClosure(const DecodedInstruction &instr);
+    void executeCallClosure(const DecodedInstruction &instr);
+    void executeCall(const DecodedInstruction &instr);
+    void executeTailCallClosure(const DecodedInstruction &instr);
+    void executeTailCall(const DecodedInstruction &instr);
+    void executeTag(const DecodedInstruction &instr);
+    void executeArray(const DecodedInstruction &instr);
+    void executeFail(const DecodedInstruction &instr);
+    void executeLine(const DecodedInstruction &instr);
 
     void executePattStr();
     void executePattString();
@@ -495,28 +583,45 @@ protected:
     void executeCallLwrite();
     void executeCallLlength();
     void executeCallLstring();
-    void executeCallBarray();
+    void executeCallBarray(const DecodedInstruction &instr);
+
+    void executeInvalidJump(const DecodedInstruction &instr);
+    void executeEndOfCode();
+
+    void executeLoadLocalValueConst(const DecodedInstruction &instr);
+    void executeLoadArgumentValueConst(const DecodedInstruction &instr);
+    void executeConstAdd(const DecodedInstruction &instr);
+    void executeConstSub(const DecodedInstruction &instr);
+    void executeLoadLocalValueCjmpz(const DecodedInstruction &instr);
+    void executeLoadArgumentValueCjmpz(const DecodedInstruction &instr);
+    void executeDupTag();
+    void executeStoreLocalValueDrop(const DecodedInstruction &instr);
 private:
     bool gcInitialized_;
-    lama::bytecode::offset_t ip_;
-    lama::bytecode::offset_t instructionStartOffset_;
-    VerificationMode mode_;
+    instr_index_t ip_;
+    const DecodedInstruction *currentInstruction_;
     alignas(16) DataStack stack_;
     utils::CallStack callstack_;
     bool isClosureCalled_;
     bool endReached_;
     const lama::bytecode::BytecodeFile *bytecodeFile_;
+    const InstructionStream *code_;
+    const DecodedInstruction *instructions_;
+    std::vector<CallSiteCache> callSiteCaches_;
+    lama::verifier::LazyVerifier *lazyVerifier_;
 
-    void setIp(lama::bytecode::offset_t newIp) {
-        ip_ = newIp;
-    }
+    /*
+     * Bases of the variables of the active frame, they are updated on calls and returns only.
+     * Captured variables live in the closure, see getCapturedValueAddress
+     */
+    lama::runtime::Word *localsBase_;
+    lama::runtime::Word *argumentsBase_;
 
-    void advanceIp(lama::bytecode::offset_t offset = 1) {
-        ip_ += offset;
-    }
+    void updateFrameBases() {
+        CallstackFrame *frame = callstack_.peekAddress();
 
-    void setInstructionStartOffset(lama::bytecode::offset_t offset) {
-        instructionStartOffset_ = offset;
+        localsBase_ = frame->getLocalValueAddress(0);
+        argumentsBase_ = frame->getArgumentValueAddress(0);
     }
 
     const lama::runtime::Word* getGlobalsStartAddress() const {
@@ -527,6 +632,23 @@ private:
         return stack_.data();
     }
 
+    lama::runtime::native_int_t computeArithBinop(
+        lama::bytecode::InstructionOpCode opcode,
+        lama::runtime::native_int_t x,
+        lama::runtime::native_int_t y
+    ) const;
+    bool computeComparisonBinop(
+        lama::bytecode::InstructionOpCode opcode,
+        lama::runtime::native_int_t x,
+        lama::runtime::native_int_t y
+    ) const;
+    bool computeEquality(lama::interpreter::runtime::Value value0, lama::interpreter::runtime::Value value1) const;
+    lama::runtime::Word computeIntBinop(
+        lama::bytecode::InstructionOpCode opcode,
+        lama::runtime::native_int_t x,
+        lama::runtime::native_int_t y
+    ) const;
+
     void executeArithBinop(lama::bytecode::InstructionOpCode opcode);
     void executeComparisonBinop(lama::bytecode::InstructionOpCode opcode);
     void executeLogicalBinop(lama::bytecode::InstructionOpCode opcode);
@@ -540,38 +662,76 @@ private:
     }
 
     void checkCodeOffset(lama::bytecode::offset_t offset) const {
-        if (mode_ == VerificationMode::DYNAMIC_VERIFICATION) {
+        if constexpr (DYNAMIC_CHECKS) {
             interpreterAssert(offset < bytecodeFile_->getCodeSize(), "code offset out of range");
         }
     }
 
+    void checkJumpTarget(const DecodedInstruction &target) const {
+        if (target.opcode == pseudo_opcode::INVALID_JUMP) {
+            const lama::runtime::native_int_t offset = target.operand0;
+
+            interpreterAssert(offset >= 0 && static_cast<std::size_t>(offset) < bytecodeFile_->getCodeSize(), "code offset out of range");
+            interpreterAssert(false, "jump target is not an instruction");
+        }
+    }
+
     void checkGlobalValueIndex(lama::bytecode::offset_t globalValueIndex) const {
-        if (mode_ == VerificationMode::DYNAMIC_VERIFICATION) {
+        if constexpr (DYNAMIC_CHECKS) {
             interpreterAssert(globalValueIndex < bytecodeFile_->getGlobalAreaSize(), "global value index out of range");
         }
     }
 
-    void checkLocalValueIndex(CallstackFrame frame, lama::bytecode::offset_t localValueIndex) const {
-        if (mode_ == VerificationMode::DYNAMIC_VERIFICATION) {
-            interpreterAssert(localValueIndex < frame.getLocalsCount(), "local value index out of range");
+    void checkLocalValueIndex(lama::bytecode::offset_t localValueIndex) const {
+        if constexpr (DYNAMIC_CHECKS) {
+            interpreterAssert(localValueIndex < peekFrame().getLocalsCount(), "local value index out of range");
         }
     }
 
-    void checkArgumentValueIndex(CallstackFrame frame, lama::bytecode::offset_t argumentValueIndex) const {
-        if (mode_ == VerificationMode::DYNAMIC_VERIFICATION) {
-            interpreterAssert(argumentValueIndex < frame.getArgumentsCount(), "argument value index out of range");
+    void checkArgumentValueIndex(lama::bytecode::offset_t argumentValueIndex) const {
+        if constexpr (DYNAMIC_CHECKS) {
+            interpreterAssert(argumentValueIndex < peekFrame().getArgumentsCount(), "argument value index out of range");
         }
     }
 
-    void checkCapturedValueIndex(CallstackFrame frame, lama::bytecode::offset_t capturedValueIndex) const {
+    void checkCapturedValueIndex(lama::bytecode::offset_t capturedValueIndex) const {
+        const CallstackFrame &frame = peekFrame();
+
         interpreterAssert(frame.hasCaptures(), "function cannot use captured values");
         interpreterAssert(capturedValueIndex < frame.getCapturesCount(), "captured value index out of range");
     }
 
     void doReturnFromFunction();
+
+    void doCallClosure(const DecodedInstruction &instr, lama::runtime::Word retIp);
+    void doCall(const DecodedInstruction &instr, lama::runtime::Word retIp);
+
+    bool canReuseFrame(std::size_t wordsNum) const;
+    lama::runtime::Word reuseFrame(std::size_t wordsNum);
+};
+
+extern template class BytecodeInterpreterState<VerificationMode::STATIC_VERIFICATION>;
+extern template class BytecodeInterpreterState<VerificationMode::DYNAMIC_VERIFICATION>;
+
+/*
+ * Native code is used for statically verified bytecode only, if the platform supports it.
+ * If the execution profile is given, the bytecode is interpreted by the profiling dispatch loop
+ * without superinstructions and native code, so that every instruction of the file is counted
+ */
+enum class ExecutionEngine {
+    INTERPRETER,
+    NATIVE_CODE,
 };
 
-void interpretBytecodeFile(bytecode::BytecodeFile *file, VerificationMode mode = VerificationMode::DYNAMIC_VERIFICATION);
+void interpretBytecodeFile(
+    const bytecode::BytecodeFile *file,
+    VerificationMode mode = VerificationMode::DYNAMIC_VERIFICATION,
+    const SuperinstructionSet &superinstructions = SuperinstructionSet{},
+    ExecutionEngine engine = ExecutionEngine::INTERPRETER,
+    bool useVerificationCache = false,
+    bool lazyVerification = false,
+    ExecutionProfile *profile = nullptr
+);
 }
 
 #endif
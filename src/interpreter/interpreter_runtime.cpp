@@ -10,21 +10,6 @@
 
 /* Value implementation */
 
-lama::interpreter::runtime::Value::Value(lama::runtime::native_uint_t val)
-    : rawWord_(lama::runtime::Word(BOX(val))) {
-
-}
-
-lama::interpreter::runtime::Value::Value(lama::runtime::native_int_t val)
-    : rawWord_(lama::runtime::Word(BOX(val))) {
-
-}
-
-lama::interpreter::runtime::Value::Value(bool val)
-    : Value(lama::runtime::native_int_t(val ? 1 : 0)) {
-
-}
-
 lama::interpreter::runtime::Value::Value(std::string_view view)
     : rawWord_(lama::runtime::Word{reinterpret_cast<std::uintptr_t>(view.data())}) {
 
@@ -40,19 +25,6 @@ lama::interpreter::runtime::Value::Value(const void *ptr)
 
 }
 
-lama::interpreter::runtime::Value::Value(lama::runtime::Word rawWord)
-    : rawWord_(rawWord) {
-
-}
-
-lama::runtime::native_int_t lama::interpreter::runtime::Value::getNativeInt() const {
-    return UNBOX(getNativeUIntRepresentation(getRawWord()));
-}
-
-lama::runtime::native_uint_t lama::interpreter::runtime::Value::getNativeUInt() const {
-    return UNBOX(getNativeUIntRepresentation(getRawWord()));
-}
-
 std::string_view lama::interpreter::runtime::Value::getString() const {
     return std::string_view{reinterpret_cast<const char *>(getNativeInt())};
 }
@@ -3,6 +3,8 @@
 
 #include "lama_runtime.hpp"
 
+#include <algorithm>
+#include <cstddef>
 #include <new>
 #include <string_view>
 
@@ -15,19 +17,45 @@ enum class LamaTag : unsigned char {
     UNBOXED = UNBOXED_TAG,
 };
 
+/*
+ * Boxing and tag tests of integers are defined in the header,
+ * so that the interpreter can keep values in registers
+ */
 class Value {
 public:
-    Value(lama::runtime::native_uint_t val);
-    Value(lama::runtime::native_int_t val);
-    Value(bool val);
+    Value(lama::runtime::native_uint_t val)
+        : rawWord_(lama::runtime::Word(BOX(val))) {
+
+    }
+
+    Value(lama::runtime::native_int_t val)
+        : rawWord_(lama::runtime::Word(BOX(val))) {
+
+    }
+
+    Value(bool val)
+        : Value(lama::runtime::native_int_t(val ? 1 : 0)) {
+
+    }
+
     Value(std::string_view view);
     Value(void *ptr);
     Value(const void *ptr);
-    explicit Value(lama::runtime::Word rawWord);
+
+    explicit Value(lama::runtime::Word rawWord)
+        : rawWord_(rawWord) {
+
+    }
+
     ~Value() = default;
 
-    lama::runtime::native_int_t getNativeInt() const;
-    lama::runtime::native_uint_t getNativeUInt() const;
+    lama::runtime::native_int_t getNativeInt() const {
+        return UNBOX(lama::runtime::getNativeUIntRepresentation(rawWord_));
+    }
+
+    lama::runtime::native_uint_t getNativeUInt() const {
+        return UNBOX(lama::runtime::getNativeUIntRepresentation(rawWord_));
+    }
 
     bool getBool() const {
         return getNativeInt() != 0;
@@ -38,7 +66,7 @@ public:
     LamaTag getTag() const;
 
     bool isInt() const {
-        return getTag() == LamaTag::UNBOXED;
+        return UNBOXED(lama::runtime::getNativeUIntRepresentation(rawWord_));
     }
 
     bool isString() const {
@@ -68,6 +96,72 @@ private:
     lama::runtime::Word rawWord_;
 };
 
+/*
+ * Fast paths of Barray, Bsexp and Bclosure: an object is bump-allocated from the GC heap (see gc.c)
+ * and filled in place, the members are not registered as extra roots since the garbage is not collected.
+ * nullptr is returned if the heap is exhausted, then the object has to be allocated by the runtime
+ */
+inline data *tryBumpAllocate(lama::runtime::native_uint_t header, std::size_t contentsWords) {
+    const std::size_t words = BYTES_TO_WORDS(DATA_HEADER_SZ) + contentsWords;
+
+    if (static_cast<std::size_t>(::heap.end - ::heap.current) < words) {
+        return nullptr;
+    }
+
+    data *obj = reinterpret_cast<data *>(::heap.current);
+    ::heap.current += words;
+
+    obj->data_header = header;
+    obj->forward_address = 0;
+
+    return obj;
+}
+
+inline void *tryAllocateArray(const lama::runtime::Word *elements, std::size_t length) {
+    data *obj = tryBumpAllocate(ARRAY_TAG | (length << 3), length);
+
+    if (obj == nullptr) {
+        return nullptr;
+    }
+
+    std::copy_n(elements, length, reinterpret_cast<lama::runtime::Word *>(obj->contents));
+
+    return obj->contents;
+}
+
+/* The tag is unboxed, the sexp points to it and is followed by the members */
+inline void *tryAllocateSexp(const lama::runtime::Word *members, std::size_t membersNumber, lama::runtime::native_uint_t tag) {
+    sexp *obj = reinterpret_cast<sexp *>(tryBumpAllocate(SEXP_TAG | (membersNumber << 3), membersNumber + 1));
+
+    if (obj == nullptr) {
+        return nullptr;
+    }
+
+    obj->tag = tag;
+    std::copy_n(members, membersNumber, reinterpret_cast<lama::runtime::Word *>(obj->contents));
+
+    return &obj->tag;
+}
+
+/* The closure holds the code offset followed by the captured values, getCapture is called for each capture index */
+template<class CaptureFunc>
+void *tryAllocateClosure(lama::runtime::Word codeOffset, std::size_t capturesNumber, CaptureFunc &&getCapture) {
+    data *obj = tryBumpAllocate(CLOSURE_TAG | ((capturesNumber + 1) << 3), capturesNumber + 1);
+
+    if (obj == nullptr) {
+        return nullptr;
+    }
+
+    lama::runtime::Word *contents = reinterpret_cast<lama::runtime::Word *>(obj->contents);
+    contents[0] = codeOffset;
+
+    for (std::size_t i = 0; i < capturesNumber; ++i) {
+        contents[i + 1] = getCapture(i);
+    }
+
+    return obj->contents;
+}
+
 template<class T, std::size_t StackCapacity>
 class GcDataStack {
 private:
@@ -152,6 +246,11 @@ public:
         return top;
     }
 
+    /* Moves the end of the stack, elements up to the new end must be already constructed */
+    void setEnd(T *ptr) {
+        __gc_stack_bottom = reinterpret_cast<std::size_t>(ptr);
+    }
+
     std::size_t size() const {
         return (__gc_stack_bottom - __gc_stack_top) / elementSize;
     }
@@ -0,0 +1,61 @@
+#include "lazy_verifier.hpp"
+
+#include "lama_runtime.hpp"
+
+lama::verifier::LazyVerifier::LazyVerifier(
+    const lama::bytecode::BytecodeFile *file,
+    lama::interpreter::InstructionStream *code
+)
+    : file_(file)
+    , code_(code)
+    , merger_(file) {
+
+}
+
+void lama::verifier::LazyVerifier::verifyEntryFunction() {
+    verifyFunction(
+        static_cast<lama::bytecode::offset_t>(file_->getEntryPointOffset()),
+        lama::runtime::MAIN_FUNCTION_ARGUMENTS
+    );
+}
+
+void lama::verifier::LazyVerifier::verifyFunction(lama::bytecode::offset_t functionBegin, std::uint32_t argsCount) {
+    // callees are verified on their own entry
+    const FunctionVerificationResult function = lama::verifier::verifyFunction(
+        file_,
+        functionBegin,
+        argsCount,
+        [](lama::bytecode::offset_t, std::uint32_t) {}
+    );
+
+    const VerificationError unverifiable{functionBegin, "function cannot be verified statically"};
+
+    switch (function.status) {
+        case FunctionVerificationResult::Status::VERIFIED:
+            break;
+        case FunctionVerificationResult::Status::UNVERIFIABLE:
+            reportVerificationError(file_, unverifiable);
+        case FunctionVerificationResult::Status::INVALID:
+            reportVerificationError(file_, function.error);
+    }
+
+    try {
+        if (!merger_.merge(function)) {
+            reportVerificationError(file_, unverifiable);
+        }
+    } catch (const VerificationError &error) {
+        reportVerificationError(file_, error);
+    }
+
+    code_->setFrameStackSize(functionBegin, merger_.getResult().getFrameStackSize(functionBegin));
+
+    for (auto&& [offset, proven] : function.intOperands) {
+        code_->setIntOperands(offset, merger_.hasIntOperands(offset));
+    }
+
+    for (auto&& [offset, destination] : function.storeDestinations) {
+        code_->setStoreDestination(offset, destination);
+    }
+
+    code_->markFunctionVerified(functionBegin);
+}
@@ -0,0 +1,35 @@
+#ifndef INTERPRETER_LAZY_VERIFIER_HPP
+#define INTERPRETER_LAZY_VERIFIER_HPP
+
+#include <cstdint>
+
+#include "instruction_stream.hpp"
+#include "verifier.hpp"
+
+#include "../bytecode/source_file.hpp"
+
+namespace lama::verifier {
+/*
+ * Verifies functions on their first entry instead of the whole file in advance, so the execution starts
+ * right after the entry function is verified. The decoder marks every function as unverified with
+ * UNVERIFIED_BEGIN/UNVERIFIED_CBEGIN, the handler of which verifies the function, patches its decoded code
+ * with the facts proven so far and restores BEGIN/CBEGIN, so later entries cost nothing.
+ * The interpreter cannot enable dynamic checks on the fly, so an unverifiable function is reported as an error
+ */
+class LazyVerifier {
+public:
+    LazyVerifier(const lama::bytecode::BytecodeFile *file, lama::interpreter::InstructionStream *code);
+
+    /* Must be called before the execution starts */
+    void verifyEntryFunction();
+
+    /* The function must not be verified yet */
+    void verifyFunction(lama::bytecode::offset_t functionBegin, std::uint32_t argsCount);
+private:
+    const lama::bytecode::BytecodeFile *file_;
+    lama::interpreter::InstructionStream *code_;
+    VerificationMerger merger_;
+};
+}
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef INTERPRETER_SUPERINSTRUCTIONS_HPP
+#define INTERPRETER_SUPERINSTRUCTIONS_HPP
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+
+#include "../bytecode/bytecode_instructions.hpp"
+
+namespace lama::interpreter {
+/*
+ * Superinstructions replace the opcode of the first instruction of a pair,
+ * the record of the second instruction stays intact, so jumps into the middle
+ * of a superinstruction are still valid.
+ * A superinstruction handler executes both instructions and skips the second record.
+ */
+namespace super_opcode {
+    constexpr lama::bytecode::InstructionOpCode LD_L_CONST = lama::bytecode::InstructionOpCode::SUPER_LD_L_CONST;
+    constexpr lama::bytecode::InstructionOpCode LD_A_CONST = lama::bytecode::InstructionOpCode::SUPER_LD_A_CONST;
+    constexpr lama::bytecode::InstructionOpCode CONST_ADD = lama::bytecode::InstructionOpCode::SUPER_CONST_ADD;
+    constexpr lama::bytecode::InstructionOpCode CONST_SUB = lama::bytecode::InstructionOpCode::SUPER_CONST_SUB;
+    constexpr lama::bytecode::InstructionOpCode LD_L_CJMPZ = lama::bytecode::InstructionOpCode::SUPER_LD_L_CJMPZ;
+    constexpr lama::bytecode::InstructionOpCode LD_A_CJMPZ = lama::bytecode::InstructionOpCode::SUPER_LD_A_CJMPZ;
+    constexpr lama::bytecode::InstructionOpCode DUP_TAG = lama::bytecode::InstructionOpCode::SUPER_DUP_TAG;
+    constexpr lama::bytecode::InstructionOpCode ST_L_DROP = lama::bytecode::InstructionOpCode::SUPER_ST_L_DROP;
+}
+
+struct Superinstruction {
+    lama::bytecode::InstructionOpCode first;
+    lama::bytecode::InstructionOpCode second;
+    lama::bytecode::InstructionOpCode fused;
+};
+
+constexpr std::array<Superinstruction, 8> SUPERINSTRUCTIONS = {{
+    {lama::bytecode::InstructionOpCode::LD_L, lama::bytecode::InstructionOpCode::CONST, super_opcode::LD_L_CONST},
+    {lama::bytecode::InstructionOpCode::LD_A, lama::bytecode::InstructionOpCode::CONST, super_opcode::LD_A_CONST},
+    {lama::bytecode::InstructionOpCode::CONST, lama::bytecode::InstructionOpCode::BINOP_ADD, super_opcode::CONST_ADD},
+    {lama::bytecode::InstructionOpCode::CONST, lama::bytecode::InstructionOpCode::BINOP_SUB, super_opcode::CONST_SUB},
+    {lama::bytecode::InstructionOpCode::LD_L, lama::bytecode::InstructionOpCode::CJMPZ, super_opcode::LD_L_CJMPZ},
+    {lama::bytecode::InstructionOpCode::LD_A, lama::bytecode::InstructionOpCode::CJMPZ, super_opcode::LD_A_CJMPZ},
+    {lama::bytecode::InstructionOpCode::DUP, lama::bytecode::InstructionOpCode::TAG, super_opcode::DUP_TAG},
+    {lama::bytecode::InstructionOpCode::ST_L, lama::bytecode::InstructionOpCode::DROP, super_opcode::ST_L_DROP},
+}};
+
+/* A set of superinstructions enabled for fusion, all of them are disabled by default */
+class SuperinstructionSet {
+public:
+    /* Returns false if there is no superinstruction for the given pair */
+    bool enable(lama::bytecode::InstructionOpCode first, lama::bytecode::InstructionOpCode second) {
+        for (std::size_t i = 0; i < SUPERINSTRUCTIONS.size(); ++i) {
+            if (SUPERINSTRUCTIONS[i].first == first && SUPERINSTRUCTIONS[i].second == second) {
+                enabled_.set(i);
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool empty() const {
+        return enabled_.none();
+    }
+
+    /* Returns the first opcode itself if the pair cannot be fused */
+    lama::bytecode::InstructionOpCode getFusedOpcode(
+        lama::bytecode::InstructionOpCode first,
+        lama::bytecode::InstructionOpCode second
+    ) const {
+        for (std::size_t i = 0; i < SUPERINSTRUCTIONS.size(); ++i) {
+            if (enabled_.test(i) && SUPERINSTRUCTIONS[i].first == first && SUPERINSTRUCTIONS[i].second == second) {
+                return SUPERINSTRUCTIONS[i].fused;
+            }
+        }
+
+        return first;
+    }
+private:
+    std::bitset<SUPERINSTRUCTIONS.size()> enabled_;
+};
+}
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef INTERPRETER_TYPE_FACTS_HPP
+#define INTERPRETER_TYPE_FACTS_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "../bytecode/source_file.hpp"
+
+namespace lama::interpreter {
+/*
+ * Abstract values tracked by the static verifier, UNKNOWN is the top of the lattice.
+ * References are produced by LDA, but they may be passed anywhere, so an UNKNOWN value may be a reference
+ */
+enum class ValueType : unsigned char {
+    UNKNOWN,
+    INT,
+    STRING,
+    ARRAY,
+    SEXP,
+    CLOSURE,
+    REFERENCE,
+};
+
+inline ValueType joinValueTypes(ValueType t1, ValueType t2) {
+    return t1 == t2 ? t1 : ValueType::UNKNOWN;
+}
+
+/*
+ * The arity of STA depends on its destination: a variable reference takes 2 operands (reference, value),
+ * an aggregate element takes 3 operands (aggregate, index, value). UNKNOWN destinations are checked at runtime
+ */
+enum class StoreDestination : unsigned char {
+    UNKNOWN,
+    REFERENCE,
+    ELEMENT,
+};
+
+/*
+ * Facts about operand types proven by the static verifier, indexed by code offset.
+ * Instructions whose operands are proven to be integers are quickened by the decoder
+ */
+class TypeFacts {
+public:
+    TypeFacts() = default;
+
+    TypeFacts(std::size_t codeSize)
+        : intOperands_(codeSize, false)
+        , storeDestinations_(codeSize, StoreDestination::UNKNOWN) {
+
+    }
+
+    bool hasIntOperands(lama::bytecode::offset_t offset) const {
+        return offset < intOperands_.size() && intOperands_[offset];
+    }
+
+    void setIntOperands(lama::bytecode::offset_t offset) {
+        intOperands_[offset] = true;
+    }
+
+    StoreDestination getStoreDestination(lama::bytecode::offset_t offset) const {
+        return offset < storeDestinations_.size() ? storeDestinations_[offset] : StoreDestination::UNKNOWN;
+    }
+
+    void setStoreDestination(lama::bytecode::offset_t offset, StoreDestination destination) {
+        storeDestinations_[offset] = destination;
+    }
+private:
+    std::vector<bool> intOperands_;
+    std::vector<StoreDestination> storeDestinations_;
+};
+}
+
+#endif
@@ -0,0 +1,365 @@
+#include "verification_cache.hpp"
+#include "verifier.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    constexpr char CACHE_MAGIC[4] = {'L', 'B', 'C', 'X'};
+    constexpr std::uint32_t CACHE_VERSION = 6;
+
+    /*
+     * Layout of a cache file:
+     * CacheHeader | content[contentSize] | FunctionRecord[functionsNumber] | BlockEntryRecord[blockEntriesNumber]
+     *     | offset[intOperandsNumber] | StoreDestinationRecord[storeDestinationsNumber]
+     * The content is a copy of the bytecode file the cache was built for, the payload hash covers the records after it
+     */
+    struct CacheHeader {
+        char magic[sizeof(CACHE_MAGIC)];
+        std::uint32_t version;
+        std::uint64_t contentSize;
+        std::uint64_t payloadHash;
+        std::uint32_t codeSize;
+        std::uint32_t verified;
+        std::uint32_t functionsNumber;
+        std::uint32_t blockEntriesNumber;
+        std::uint32_t intOperandsNumber;
+        std::uint32_t storeDestinationsNumber;
+    };
+
+    struct FunctionRecord {
+        std::uint32_t offset;
+        std::uint32_t argsCount;
+        std::uint32_t localsCount;
+        std::uint32_t maxStackSize;
+    };
+
+    struct BlockEntryRecord {
+        std::uint32_t offset;
+        std::uint32_t depth;
+    };
+
+    struct StoreDestinationRecord {
+        std::uint32_t offset;
+        std::uint32_t destination;
+    };
+
+    /* 64-bit FNV-1a, it detects corruption, but it is not collision resistant, so it never identifies the code */
+    class Hasher {
+    public:
+        void update(const void *data, std::size_t size) {
+            const unsigned char *bytes = static_cast<const unsigned char *>(data);
+
+            for (std::size_t i = 0; i < size; ++i) {
+                hash_ = (hash_ ^ bytes[i]) * 0x100000001b3;
+            }
+        }
+
+        std::uint64_t getHash() const {
+            return hash_;
+        }
+    private:
+        std::uint64_t hash_ = 0xcbf29ce484222325;
+    };
+
+    std::uint64_t hashPayload(const std::byte *payload, std::size_t size) {
+        Hasher hasher;
+        hasher.update(payload, size);
+
+        return hasher.getHash();
+    }
+
+    void appendBytes(std::vector<std::byte> &buffer, const void *data, std::size_t size) {
+        const std::byte *bytes = static_cast<const std::byte *>(data);
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    }
+
+    template<class T>
+    void appendBytes(std::vector<std::byte> &buffer, const T &value) {
+        appendBytes(buffer, &value, sizeof(value));
+    }
+
+    /* The parts of the bytecode file the verification depends on, the cache is valid only for the same bytes */
+    std::vector<std::byte> getBytecodeFileContent(const lama::bytecode::BytecodeFile &file) {
+        const lama::bytecode::bytefile_t *bf = file.getRawBytefile();
+
+        std::vector<std::byte> content;
+        appendBytes(content, bf->stringtab_size);
+        appendBytes(content, bf->global_area_size);
+        appendBytes(content, bf->public_symbols_number);
+        appendBytes(content, bf->public_ptr, bf->public_symbols_number * sizeof(lama::bytecode::public_symbol_t));
+        appendBytes(content, bf->string_ptr, bf->stringtab_size);
+        appendBytes(content, bf->code_ptr, file.getCodeSize());
+
+        return content;
+    }
+
+    /* A cache written by anybody else could turn the checks off, see the trust model in verification_cache.hpp */
+    bool isCacheFileTrusted(int fd) {
+        struct ::stat st;
+
+        if (::fstat(fd, &st) != 0) {
+            return false;
+        }
+
+        return S_ISREG(st.st_mode) && st.st_uid == ::geteuid() && (st.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+    }
+
+    /*
+     * The file is checked and read through the same descriptor, so it cannot be replaced in between,
+     * and a symbolic link is not followed to a file of somebody else
+     */
+    std::optional<std::vector<std::byte>> readTrustedCacheFile(const std::filesystem::path &path) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+
+        if (fd < 0) {
+            return std::nullopt;
+        }
+
+        std::optional<std::vector<std::byte>> contents;
+
+        if (isCacheFileTrusted(fd)) {
+            contents.emplace();
+
+            std::byte buffer[4096];
+            ::ssize_t bytesRead;
+
+            while ((bytesRead = ::read(fd, buffer, sizeof(buffer))) > 0) {
+                contents->insert(contents->end(), buffer, buffer + bytesRead);
+            }
+
+            if (bytesRead < 0) {
+                contents.reset();
+            }
+        }
+
+        ::close(fd);
+
+        return contents;
+    }
+
+    template<class T>
+    T readBytes(const std::byte *data) {
+        T value;
+        std::memcpy(&value, data, sizeof(value));
+
+        return value;
+    }
+}
+
+std::filesystem::path lama::verifier::getVerificationCachePath(std::string_view bytecodePath) {
+    return std::filesystem::path{bytecodePath}.replace_extension(".bcx");
+}
+
+std::optional<lama::interpreter::VerificationResult> lama::verifier::loadVerificationCache(
+    const std::filesystem::path &path,
+    const lama::bytecode::BytecodeFile &file
+) {
+    using lama::interpreter::StoreDestination;
+
+    const std::optional<std::vector<std::byte>> contents = readTrustedCacheFile(path);
+
+    if (!contents || contents->size() < sizeof(CacheHeader)) {
+        return std::nullopt;
+    }
+
+    const CacheHeader header = readBytes<CacheHeader>(contents->data());
+
+    const std::size_t codeSize = file.getCodeSize();
+    const std::vector<std::byte> content = getBytecodeFileContent(file);
+
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0
+        || header.version != CACHE_VERSION
+        || header.codeSize != codeSize
+        || header.contentSize != content.size()
+        || contents->size() - sizeof(CacheHeader) < content.size()
+        || std::memcmp(contents->data() + sizeof(CacheHeader), content.data(), content.size()) != 0) {
+        return std::nullopt;
+    }
+
+    const std::size_t functionsSize = std::size_t{header.functionsNumber} * sizeof(FunctionRecord);
+    const std::size_t blockEntriesSize = std::size_t{header.blockEntriesNumber} * sizeof(BlockEntryRecord);
+    const std::size_t intOperandsSize = std::size_t{header.intOperandsNumber} * sizeof(std::uint32_t);
+    const std::size_t storeDestinationsSize = std::size_t{header.storeDestinationsNumber} * sizeof(StoreDestinationRecord);
+    const std::size_t payloadSize = functionsSize + blockEntriesSize + intOperandsSize + storeDestinationsSize;
+
+    if (contents->size() - sizeof(CacheHeader) - content.size() != payloadSize) {
+        return std::nullopt;
+    }
+
+    const std::byte *payload = contents->data() + sizeof(CacheHeader) + content.size();
+
+    if (hashPayload(payload, payloadSize) != header.payloadHash) {
+        return std::nullopt;
+    }
+
+    if (header.verified == 0) {
+        return lama::interpreter::VerificationResult{};
+    }
+
+    const std::byte *functions = payload;
+    const std::byte *blockEntries = functions + functionsSize;
+    const std::byte *intOperands = blockEntries + blockEntriesSize;
+    const std::byte *storeDestinations = intOperands + intOperandsSize;
+
+    lama::interpreter::VerificationResult result{codeSize};
+
+    for (std::uint32_t i = 0; i < header.functionsNumber; ++i) {
+        const FunctionRecord record = readBytes<FunctionRecord>(functions + i * sizeof(FunctionRecord));
+
+        if (record.offset >= codeSize) {
+            return std::nullopt;
+        }
+
+        result.updateFunction(record.offset, {record.argsCount, record.localsCount, record.maxStackSize});
+    }
+
+    for (std::uint32_t i = 0; i < header.blockEntriesNumber; ++i) {
+        const auto [offset, depth] = readBytes<BlockEntryRecord>(blockEntries + i * sizeof(BlockEntryRecord));
+
+        if (offset >= codeSize) {
+            return std::nullopt;
+        }
+
+        result.setBlockEntryDepth(offset, depth);
+    }
+
+    for (std::uint32_t i = 0; i < header.intOperandsNumber; ++i) {
+        const std::uint32_t offset = readBytes<std::uint32_t>(intOperands + i * sizeof(std::uint32_t));
+
+        if (offset >= codeSize) {
+            return std::nullopt;
+        }
+
+        result.getTypeFacts().setIntOperands(offset);
+    }
+
+    for (std::uint32_t i = 0; i < header.storeDestinationsNumber; ++i) {
+        const auto [offset, destination] = readBytes<StoreDestinationRecord>(storeDestinations + i * sizeof(StoreDestinationRecord));
+
+        if (offset >= codeSize
+            || (destination != static_cast<std::uint32_t>(StoreDestination::REFERENCE)
+                && destination != static_cast<std::uint32_t>(StoreDestination::ELEMENT))) {
+            return std::nullopt;
+        }
+
+        result.getTypeFacts().setStoreDestination(offset, static_cast<StoreDestination>(destination));
+    }
+
+    result.setVerified(true);
+
+    return result;
+}
+
+void lama::verifier::saveVerificationCache(
+    const std::filesystem::path &path,
+    const lama::bytecode::BytecodeFile &file,
+    const lama::interpreter::VerificationResult &result
+) {
+    using lama::interpreter::StoreDestination;
+
+    const lama::interpreter::TypeFacts &typeFacts = result.getTypeFacts();
+
+    CacheHeader header{};
+    std::vector<std::byte> payload;
+
+    for (auto&& [offset, info] : result.getFunctions()) {
+        appendBytes(payload, FunctionRecord{offset, info.argsCount, info.localsCount, info.maxStackSize});
+        ++header.functionsNumber;
+    }
+
+    for (auto&& [offset, depth] : result.getBlockEntryDepths()) {
+        appendBytes(payload, BlockEntryRecord{offset, depth});
+        ++header.blockEntriesNumber;
+    }
+
+    for (lama::bytecode::offset_t offset = 0; offset < file.getCodeSize(); ++offset) {
+        if (typeFacts.hasIntOperands(offset)) {
+            appendBytes(payload, std::uint32_t{offset});
+            ++header.intOperandsNumber;
+        }
+    }
+
+    for (lama::bytecode::offset_t offset = 0; offset < file.getCodeSize(); ++offset) {
+        const StoreDestination destination = typeFacts.getStoreDestination(offset);
+
+        if (destination != StoreDestination::UNKNOWN) {
+            appendBytes(payload, StoreDestinationRecord{offset, static_cast<std::uint32_t>(destination)});
+            ++header.storeDestinationsNumber;
+        }
+    }
+
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    const std::vector<std::byte> content = getBytecodeFileContent(file);
+
+    header.contentSize = content.size();
+    header.payloadHash = hashPayload(payload.data(), payload.size());
+    header.codeSize = file.getCodeSize();
+    header.verified = result.isVerified();
+
+    // concurrent runs of the same file must not observe a partially written cache
+    std::filesystem::path tmpPath = path;
+    tmpPath += ".tmp" + std::to_string(::getpid());
+
+    {
+        std::ofstream ofs{tmpPath, std::ios::binary | std::ios::trunc};
+
+        ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        ofs.write(reinterpret_cast<const char *>(content.data()), content.size());
+        ofs.write(reinterpret_cast<const char *>(payload.data()), payload.size());
+
+        if (!ofs) {
+            std::error_code ec;
+            std::filesystem::remove(tmpPath, ec);
+
+            return;
+        }
+    }
+
+    // the cache is not trusted if others can write it, whatever the umask is
+    std::error_code ec;
+    std::filesystem::permissions(
+        tmpPath,
+        std::filesystem::perms::group_write | std::filesystem::perms::others_write,
+        std::filesystem::perm_options::remove,
+        ec
+    );
+    std::filesystem::rename(tmpPath, path, ec);
+
+    if (ec) {
+        std::filesystem::remove(tmpPath, ec);
+    }
+}
+
+bool lama::verifier::verifyBytecodeFileCached(
+    const lama::bytecode::BytecodeFile *file,
+    lama::interpreter::VerificationResult *result
+) {
+    const std::filesystem::path cachePath = getVerificationCachePath(file->getFilePath());
+
+    std::optional<lama::interpreter::VerificationResult> cached = loadVerificationCache(cachePath, *file);
+
+    if (!cached) {
+        cached.emplace();
+        verifyBytecodeFile(file, &*cached);
+        saveVerificationCache(cachePath, *file, *cached);
+    }
+
+    const bool verified = cached->isVerified();
+
+    if (result != nullptr) {
+        *result = std::move(*cached);
+    }
+
+    return verified;
+}
@@ -0,0 +1,42 @@
+#ifndef INTERPRETER_VERIFICATION_CACHE_HPP
+#define INTERPRETER_VERIFICATION_CACHE_HPP
+
+#include <filesystem>
+#include <optional>
+#include <string_view>
+
+#include "verification_result.hpp"
+
+#include "../bytecode/source_file.hpp"
+
+namespace lama::verifier {
+/*
+ * Results of the static verification are saved next to the bytecode file (<name>.bcx), so later runs
+ * of the same file skip the verification. A cache holds a copy of the bytecode file contents and is used
+ * only if the copy is equal to the file byte for byte.
+ *
+ * The cached facts are not checked against the code: frame sizes, integer operands and STA arities remove
+ * the runtime checks, so a forged cache is as dangerous as no verification at all. The copy and the hash
+ * of the facts protect the cache from stale contents and corruption only. A cache is therefore ignored unless
+ * it is a regular file (not a symbolic link) owned by the effective user and not writable by the group or others
+ */
+std::filesystem::path getVerificationCachePath(std::string_view bytecodePath);
+
+/* Returns std::nullopt if there is no valid cache for the file contents */
+std::optional<lama::interpreter::VerificationResult> loadVerificationCache(
+    const std::filesystem::path &path,
+    const bytecode::BytecodeFile &file
+);
+
+/* The cache is an optimization only, so write errors are ignored */
+void saveVerificationCache(
+    const std::filesystem::path &path,
+    const bytecode::BytecodeFile &file,
+    const lama::interpreter::VerificationResult &result
+);
+
+/* Same as verifyBytecodeFile, but the result is taken from the cache if it is valid and saved otherwise */
+bool verifyBytecodeFileCached(const bytecode::BytecodeFile *file, lama::interpreter::VerificationResult *result);
+}
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef INTERPRETER_VERIFICATION_RESULT_HPP
+#define INTERPRETER_VERIFICATION_RESULT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+
+#include "type_facts.hpp"
+
+#include "../bytecode/source_file.hpp"
+
+namespace lama::interpreter {
+/* Frame layout of a function proven by the static verifier */
+struct FunctionFrameInfo {
+    std::uint32_t argsCount;
+    std::uint32_t localsCount;
+    std::uint32_t maxStackSize;
+};
+
+/*
+ * Everything the static verifier has proven about a bytecode file. The result is kept aside of the file,
+ * so the code stays immutable and one file can be verified and executed by several users at once.
+ * Functions are keyed by the code offset of their BEGIN/CBEGIN, block entry depths (the operand stack size
+ * of the frame) are keyed by the code offset of jump targets and function entries.
+ * A default constructed result means that the file has not been verified
+ */
+class VerificationResult {
+public:
+    VerificationResult() = default;
+
+    VerificationResult(std::size_t codeSize)
+        : verified_(false)
+        , typeFacts_(codeSize) {
+
+    }
+
+    bool isVerified() const {
+        return verified_;
+    }
+
+    void setVerified(bool verified) {
+        verified_ = verified;
+    }
+
+    const FunctionFrameInfo* findFunction(lama::bytecode::offset_t functionBegin) const {
+        const auto it = functions_.find(functionBegin);
+
+        return it != functions_.end() ? &it->second : nullptr;
+    }
+
+    /* Returns 0 if the function is unknown */
+    std::uint32_t getFrameStackSize(lama::bytecode::offset_t functionBegin) const {
+        const FunctionFrameInfo *info = findFunction(functionBegin);
+
+        return info != nullptr ? info->maxStackSize : 0;
+    }
+
+    /* The frame stack size is the maximum over all exits of the function */
+    void updateFunction(lama::bytecode::offset_t functionBegin, const FunctionFrameInfo &info) {
+        const auto [it, inserted] = functions_.try_emplace(functionBegin, info);
+
+        if (!inserted && it->second.maxStackSize < info.maxStackSize) {
+            it->second.maxStackSize = info.maxStackSize;
+        }
+    }
+
+    const std::unordered_map<lama::bytecode::offset_t, FunctionFrameInfo>& getFunctions() const {
+        return functions_;
+    }
+
+    std::optional<std::uint32_t> getBlockEntryDepth(lama::bytecode::offset_t offset) const {
+        const auto it = blockEntryDepths_.find(offset);
+
+        return it != blockEntryDepths_.end() ? std::optional{it->second} : std::nullopt;
+    }
+
+    void setBlockEntryDepth(lama::bytecode::offset_t offset, std::uint32_t depth) {
+        blockEntryDepths_[offset] = depth;
+    }
+
+    const std::unordered_map<lama::bytecode::offset_t, std::uint32_t>& getBlockEntryDepths() const {
+        return blockEntryDepths_;
+    }
+
+    const TypeFacts& getTypeFacts() const {
+        return typeFacts_;
+    }
+
+    TypeFacts& getTypeFacts() {
+        return typeFacts_;
+    }
+private:
+    bool verified_ = false;
+    std::unordered_map<lama::bytecode::offset_t, FunctionFrameInfo> functions_;
+    std::unordered_map<lama::bytecode::offset_t, std::uint32_t> blockEntryDepths_;
+    TypeFacts typeFacts_;
+};
+}
+
+#endif
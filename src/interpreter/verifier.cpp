@@ -1,9 +1,21 @@
 #include "verifier.hpp"
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "lama_runtime.hpp"
 
+#include "../bytecode/decoder.hpp"
+
 namespace {
     enum class CaptureType : unsigned char {
         GLOBAL = 0x0,
@@ -13,68 +25,78 @@ namespace {
     };
 }
 
-lama::verifier::BytecodeVerifier::BytecodeVerifier(lama::bytecode::BytecodeFile *bytecodeFile)
-    : ip_(0)
-    , instructionStartOffset_(0)
+lama::verifier::BytecodeVerifier::BytecodeVerifier(
+    const lama::bytecode::BytecodeFile *bytecodeFile,
+    lama::bytecode::offset_t functionBegin,
+    std::uint32_t argsCount,
+    FunctionFoundCallback functionFound
+)
+    : ip_(functionBegin)
+    , instructionStartOffset_(functionBegin)
+    , functionBegin_(functionBegin)
+    , argsCount_(argsCount)
+    , localsCount_(0)
+    , maxStackSize_(0)
+    , functionFound_(std::move(functionFound))
     , currentState_({
-        /* functionBegin = */ static_cast<lama::bytecode::offset_t>(bytecodeFile->getEntryPointOffset()),
-        /* argsCount = */ lama::runtime::MAIN_FUNCTION_ARGUMENTS,
-        /* startIp = */ static_cast<lama::bytecode::offset_t>(bytecodeFile->getEntryPointOffset()),
+        /* startIp = */ functionBegin,
         /* localsCount = */ 0,
         /* stackSize = */ 0,
-        /* maxStackSize = */ 0,
-        /* callstackSize = */ 1
+        /* types = */ {}
     })
-    , stackSizes_(bytecodeFile->getCodeSize())
     , pushNextState_(true)
     , bytecodeFile_(bytecodeFile) {
+    markBlockEntry(functionBegin);
+
     worklist_.push_back(currentState_);
 }
 
-void lama::verifier::BytecodeVerifier::saveStackSizeInfo(
-    lama::bytecode::offset_t offset,
-    std::uint16_t stackSize,
-    std::uint16_t localsNum
-) {
-    verifierAssert(offset + sizeof(std::int32_t) <= bytecodeFile_->getCodeSize(), "offset to save stack size out of bounds");
+bool lama::verifier::TypeState::join(const TypeState &other) {
+    bool changed = false;
 
-    std::uint32_t oldval;
-    bytecodeFile_->copyCodeBytes(
-        reinterpret_cast<std::byte *>(&oldval),
-        offset,
-        sizeof(oldval)
-    );
+    // the stack sizes are equal, it is checked by the verifier
+    for (std::size_t i = 0; i < stack.size() && i < other.stack.size(); ++i) {
+        const ValueType joined = lama::interpreter::joinValueTypes(stack[i], other.stack[i]);
+        changed |= joined != stack[i];
+        stack[i] = joined;
+    }
 
-    const std::uint16_t oldStackSize = (oldval >> 16) & 0xfff;
+    if (locals.size() != other.locals.size()) {
+        // the same code is shared by different functions, nothing is known about their locals
+        changed |= !locals.empty();
+        locals.clear();
+        escapedLocals.clear();
 
-    if (oldval >= stackSize) {
-        return;
+        return changed;
     }
 
-    const std::uint32_t val = static_cast<std::uint32_t>(stackSize) << 16 | localsNum;
-    bytecodeFile_->writeBytes(
-        reinterpret_cast<const std::byte *>(&val),
-        offset,
-        sizeof(val)
-    );
+    for (std::size_t i = 0; i < locals.size(); ++i) {
+        const ValueType joined = lama::interpreter::joinValueTypes(locals[i], other.locals[i]);
+        const bool escaped = escapedLocals[i] || other.escapedLocals[i];
+        changed |= joined != locals[i] || escaped != escapedLocals[i];
+        locals[i] = joined;
+        escapedLocals[i] = escaped;
+    }
+
+    return changed;
 }
 
 void lama::verifier::BytecodeVerifier::verifyBinop() {
     popWords(2);
-    pushWord();
+    pushWord(ValueType::INT);
 }
 
 void lama::verifier::BytecodeVerifier::verifyConst() {
     fetchInt32();
 
-    pushWord();
+    pushWord(ValueType::INT);
 }
 
 void lama::verifier::BytecodeVerifier::verifyString() {
     const std::uint32_t stringIndex = fetchInt32();
     checkStringIndex(stringIndex);
 
-    pushWord();
+    pushWord(ValueType::STRING);
 }
 
 void lama::verifier::BytecodeVerifier::verifySexp() {
@@ -85,12 +107,49 @@ void lama::verifier::BytecodeVerifier::verifySexp() {
     checkNonNegative(n, "sexp members count must not be negative");
 
     popWords(n);
-    pushWord();
+    pushWord(ValueType::SEXP);
 }
 
 void lama::verifier::BytecodeVerifier::verifySti() {
+    const ValueType valueType = peekType();
+
     popWords(2);
-    pushWord();
+    pushWord(valueType);
+}
+
+/*
+ * The arity of STA is known statically only if its destination is a reference produced by LDA (2 operands)
+ * or an integer index (3 operands). A destination of unknown type may be either of them, since references
+ * are passed through arguments, globals, captures, aggregates and calls, so the arity is known at runtime only
+ */
+bool lama::verifier::BytecodeVerifier::verifySta() {
+    const ValueType valueType = peekType();
+    const ValueType destinationType = peekType(2);
+
+    StoreDestination destination;
+
+    if (destinationType == ValueType::REFERENCE) {
+        destination = StoreDestination::REFERENCE;
+    } else if (destinationType == ValueType::INT) {
+        destination = StoreDestination::ELEMENT;
+    } else if (destinationType == ValueType::UNKNOWN) {
+        return false;  // either kind of destination may reach the instruction
+    } else {
+        return false;  // an aggregate is used as a reference, the runtime handles it as a reference store
+    }
+
+    StoreDestination &knownDestination = storeDestinations_[getInstructionStartOffset()];
+
+    if (knownDestination != StoreDestination::UNKNOWN && knownDestination != destination) {
+        return false;  // both kinds of destinations reach the instruction, so its arity is known at runtime only
+    }
+
+    knownDestination = destination;
+
+    popWords(destination == StoreDestination::REFERENCE ? 2 : 3);
+    pushWord(valueType);
+
+    return true;
 }
 
 void lama::verifier::BytecodeVerifier::verifyJmp() {
@@ -99,15 +158,8 @@ void lama::verifier::BytecodeVerifier::verifyJmp() {
 
     setIp(newIp);
 
-    pushState({
-        /* functionBegin = */ currentState_.functionBegin,
-        /* argsCount = */ currentState_.argsCount,
-        /* startIp = */ newIp,
-        /* localsCount = */ currentState_.localsCount,
-        /* stackSize = */ currentState_.stackSize,
-        /* maxStackSize = */ currentState_.maxStackSize,
-        /* callstackSize = */ currentState_.callstackSize
-    });
+    markBlockEntry(newIp);
+    pushState(makeNextState(newIp));
 
     pushNextState_ = false;
 }
@@ -115,14 +167,6 @@ void lama::verifier::BytecodeVerifier::verifyJmp() {
 void lama::verifier::BytecodeVerifier::verifyReturn() {
     verifierAssert(currentState_.stackSize == 1, "one word expected to be present at the operand stack frame");
 
-    popFrame();
-
-    saveStackSizeInfo(
-        currentState_.functionBegin + sizeof(bytecode::InstructionOpCode) + sizeof(std::uint32_t),
-        currentState_.maxStackSize,
-        currentState_.localsCount
-    );
-
     pushNextState_ = false;
 }
 
@@ -131,13 +175,24 @@ void lama::verifier::BytecodeVerifier::verifyDrop() {
 }
 
 void lama::verifier::BytecodeVerifier::verifyDup() {
+    const ValueType type = peekType();
+
     popWord();
     pushWords(2);
+
+    setTopType(type, 1);
+    setTopType(type, 2);
 }
 
 void lama::verifier::BytecodeVerifier::verifySwap() {
+    const ValueType type1 = peekType(1);
+    const ValueType type2 = peekType(2);
+
     popWords(2);
     pushWords(2);
+
+    setTopType(type2, 1);
+    setTopType(type1, 2);
 }
 
 void lama::verifier::BytecodeVerifier::verifyElem() {
@@ -156,12 +211,12 @@ void lama::verifier::BytecodeVerifier::verifyLocalLoad() {
     const lama::bytecode::offset_t localValueIndex = fetchInt32();
     checkLocalValueIndex(currentState_, localValueIndex);
 
-    pushWord();
+    pushWord(getLocalType(localValueIndex));
 }
 
 void lama::verifier::BytecodeVerifier::verifyArgumentLoad() {
     const lama::bytecode::offset_t argValueIndex = fetchInt32();
-    checkArgumentValueIndex(currentState_, argValueIndex);
+    checkArgumentValueIndex(argValueIndex);
 
     pushWord();
 }
@@ -173,36 +228,60 @@ void lama::verifier::BytecodeVerifier::verifyCapturedLoad() {
     pushWord();
 }
 
+void lama::verifier::BytecodeVerifier::verifyGlobalAddressLoad() {
+    verifyGlobalLoad();
+    setTopType(ValueType::REFERENCE);
+}
+
+void lama::verifier::BytecodeVerifier::verifyLocalAddressLoad() {
+    const lama::bytecode::offset_t localValueIndex = fetchInt32();
+    checkLocalValueIndex(currentState_, localValueIndex);
+
+    escapeLocal(localValueIndex);
+
+    pushWord(ValueType::REFERENCE);
+}
+
+void lama::verifier::BytecodeVerifier::verifyArgumentAddressLoad() {
+    verifyArgumentLoad();
+    setTopType(ValueType::REFERENCE);
+}
+
+void lama::verifier::BytecodeVerifier::verifyCapturedAddressLoad() {
+    verifyCapturedLoad();
+    setTopType(ValueType::REFERENCE);
+}
+
 void lama::verifier::BytecodeVerifier::verifyGlobalStore() {
     const lama::bytecode::offset_t globalValueIndex = fetchInt32();
     checkGlobalValueIndex(globalValueIndex);
 
-    popWord();
-    pushWord();
+    // the stored value stays on the stack
+    checkStackUnderflow();
 }
 
 void lama::verifier::BytecodeVerifier::verifyLocalStore() {
     const lama::bytecode::offset_t localValueIndex = fetchInt32();
     checkLocalValueIndex(currentState_, localValueIndex);
 
-    popWord();
-    pushWord();
+    // the stored value stays on the stack
+    setLocalType(localValueIndex, peekType());
 }
 
 void lama::verifier::BytecodeVerifier::verifyArgumentStore() {
     const lama::bytecode::offset_t argValueIndex = fetchInt32();
-    checkArgumentValueIndex(currentState_, argValueIndex);
+    checkArgumentValueIndex(argValueIndex);
 
-    popWord();
-    pushWord();
+    // the stored value stays on the stack
+    checkStackUnderflow();
 }
 
 void lama::verifier::BytecodeVerifier::verifyCapturedStore() {
     const lama::bytecode::offset_t capturedValueIndex = fetchInt32();
     checkCapturedValueIndex(capturedValueIndex);
 
-    popWord();
-    pushWord();
+    // the stored value stays on the stack
+    checkStackUnderflow();
 }
 
 void lama::verifier::BytecodeVerifier::verifyConditionalJmp() {
@@ -211,25 +290,9 @@ void lama::verifier::BytecodeVerifier::verifyConditionalJmp() {
 
     popWord();
 
-    pushState({
-        /* functionBegin = */ currentState_.functionBegin,
-        /* argsCount = */ currentState_.argsCount,
-        /* startIp = */ newIp,
-        /* localsCount = */ currentState_.localsCount,
-        /* stackSize = */ currentState_.stackSize,
-        /* maxStackSize = */ currentState_.maxStackSize,
-        /* callstackSize = */ currentState_.callstackSize
-    });
-
-    pushState({
-        /* functionBegin = */ currentState_.functionBegin,
-        /* argsCount = */ currentState_.argsCount,
-        /* startIp = */ getIp(),
-        /* localsCount = */ currentState_.localsCount,
-        /* stackSize = */ currentState_.stackSize,
-        /* maxStackSize = */ currentState_.maxStackSize,
-        /* callstackSize = */ currentState_.callstackSize
-    });
+    markBlockEntry(newIp);
+    pushState(makeNextState(newIp));
+    pushState(makeNextState(getIp()));
 
     pushNextState_ = false;
 }
@@ -237,45 +300,45 @@ void lama::verifier::BytecodeVerifier::verifyConditionalJmp() {
 void lama::verifier::BytecodeVerifier::verifyBegin() {
     const std::int32_t argsNum = fetchInt32();
     checkArgumentsNumber(argsNum);
-    verifierAssert(argsNum == currentState_.argsCount, "the number of passed arguments differs from the number declared in BEGIN");
+    verifierAssert(static_cast<std::uint32_t>(argsNum) == argsCount_, "the number of passed arguments differs from the number declared in BEGIN");
 
-    /*
-     * Despite the 4 bytes for the local vars number, the verifier will save (localsNum & 0xffff) in
-     * the 2 lower bytes of second parameter of BEGIN instruction. There will be only 2 bytes
-     * left for number of local vars
-     */
-    const std::int16_t localsNum = fetchInt32();
+    const std::int32_t localsNum = fetchInt32();
     checkLocalsNumber(localsNum);
 
     currentState_.localsCount = localsNum;
+    localsCount_ = localsNum;
+
+    // locals are initialized with boxed zeros
+    currentState_.types.locals.assign(localsNum, ValueType::INT);
+    currentState_.types.escapedLocals.assign(localsNum, false);
 }
 
 void lama::verifier::BytecodeVerifier::verifyClosureBegin() {
     const std::int32_t argsNum = fetchInt32();
     checkArgumentsNumber(argsNum);
-    verifierAssert(argsNum == currentState_.argsCount, "the number of passed arguments differs from the number declared in CBEGIN");
+    verifierAssert(static_cast<std::uint32_t>(argsNum) == argsCount_, "the number of passed arguments differs from the number declared in CBEGIN");
 
-    /*
-     * Despite the 4 bytes for the local vars number, the verifier will save (localsNum & 0xffff) in
-     * the 2 lower bytes of second parameter of CBEGIN instruction. There will be only 2 bytes
-     * left for number of local vars
-     */
-    const std::int16_t localsNum = fetchInt32();
+    const std::int32_t localsNum = fetchInt32();
     checkLocalsNumber(localsNum);
 
     currentState_.localsCount = localsNum;
+    localsCount_ = localsNum;
+
+    // locals are initialized with boxed zeros
+    currentState_.types.locals.assign(localsNum, ValueType::INT);
+    currentState_.types.escapedLocals.assign(localsNum, false);
 }
 
 void lama::verifier::BytecodeVerifier::verifyClosure() {
     const lama::bytecode::offset_t locationAddress = fetchInt32();
-    checkCodeOffset(locationAddress);
-
-    const lama::bytecode::InstructionOpCode locationOp = lookupInstrOpCode(locationAddress);
-    verifierAssert(
-        locationOp == lama::bytecode::InstructionOpCode::BEGIN || locationOp == lama::bytecode::InstructionOpCode::CBEGIN,
+    const std::uint32_t declaredArgsNum = checkFunctionBegin(
+        locationAddress,
         "closure function should start with BEGIN or CBEGIN instruction"
     );
 
+    // the arguments number is checked at runtime by CALLC
+    functionFound_(locationAddress, declaredArgsNum);
+
     const std::int32_t argsNum = fetchInt32();
     checkArgumentsNumber(argsNum);
 
@@ -291,7 +354,7 @@ void lama::verifier::BytecodeVerifier::verifyClosure() {
                 checkLocalValueIndex(currentState_, index);
                 break;
             case CaptureType::ARGUMENT:
-                checkArgumentValueIndex(currentState_, index);
+                checkArgumentValueIndex(index);
                 break;
             case CaptureType::CAPTURE:
                 checkCapturedValueIndex(index);
@@ -302,7 +365,7 @@ void lama::verifier::BytecodeVerifier::verifyClosure() {
         }
     }
 
-    pushWord();
+    pushWord(ValueType::CLOSURE);
 }
 
 void lama::verifier::BytecodeVerifier::verifyCallClosure() {
@@ -315,31 +378,42 @@ void lama::verifier::BytecodeVerifier::verifyCallClosure() {
 
 void lama::verifier::BytecodeVerifier::verifyCall() {
     const lama::bytecode::offset_t locationAddress = fetchInt32();
-    checkCodeOffset(locationAddress);
+    const std::uint32_t declaredArgsNum = checkFunctionBegin(
+        locationAddress,
+        "called function should start with BEGIN or CBEGIN instruction"
+    );
 
     const std::int32_t argsNum = fetchInt32();
     checkArgumentsNumber(argsNum);
 
-    pushState({
-        /* functionBegin = */ locationAddress,
-        /* argsCount = */ static_cast<std::uint16_t>(argsNum),
-        /* startIp = */ locationAddress,
-        /* localsCount = */ 0,
-        /* stackSize = */ 0,
-        /* maxStackSize = */ 0,
-        /* callstackSize = */ static_cast<uint16_t>(currentState_.callstackSize + 1),
-    });
-    pushState({
-        /* functionBegin = */ currentState_.functionBegin,
-        /* argsCount = */ currentState_.argsCount,
-        /* startIp = */ getIp(),
-        /* localsCount = */ currentState_.localsCount,
-        /* stackSize = */ static_cast<uint16_t>(currentState_.stackSize - argsNum + 1),
-        /* maxStackSize = */ currentState_.maxStackSize,
-        /* callstackSize = */ currentState_.callstackSize
-    });
+    // every call site is checked, so the callee is verified once
+    verifierAssert(
+        static_cast<std::uint32_t>(argsNum) == declaredArgsNum,
+        "the number of passed arguments differs from the number declared by the called function"
+    );
 
-    pushNextState_ = false;
+    functionFound_(locationAddress, declaredArgsNum);
+
+    popWords(argsNum);
+    pushWord();
+}
+
+std::uint32_t lama::verifier::BytecodeVerifier::checkFunctionBegin(
+    lama::bytecode::offset_t functionBegin,
+    std::string_view message
+) const {
+    checkCodeOffset(functionBegin);
+
+    const lama::bytecode::InstructionOpCode op = lookupInstrOpCode(functionBegin);
+    verifierAssert(
+        op == lama::bytecode::InstructionOpCode::BEGIN || op == lama::bytecode::InstructionOpCode::CBEGIN,
+        message
+    );
+
+    const std::int32_t argsNum = lookupInt32(functionBegin + 1);
+    checkArgumentsNumber(argsNum);
+
+    return argsNum;
 }
 
 void lama::verifier::BytecodeVerifier::verifyTag() {
@@ -350,7 +424,7 @@ void lama::verifier::BytecodeVerifier::verifyTag() {
     checkNonNegative(n, "sexp members count must not be negative");
 
     popWord();
-    pushWord();
+    pushWord(ValueType::INT);
 }
 
 void lama::verifier::BytecodeVerifier::verifyArray() {
@@ -358,7 +432,7 @@ void lama::verifier::BytecodeVerifier::verifyArray() {
     checkNonNegative(n, "array length must not be negative");
 
     popWord();
-    pushWord();
+    pushWord(ValueType::INT);
 }
 
 void lama::verifier::BytecodeVerifier::verifyFail() {
@@ -370,12 +444,6 @@ void lama::verifier::BytecodeVerifier::verifyFail() {
 
     popWord();
 
-    saveStackSizeInfo(
-        currentState_.functionBegin + sizeof(bytecode::InstructionOpCode) + sizeof(std::uint32_t),
-        currentState_.maxStackSize,
-        currentState_.localsCount
-    );
-
     pushNextState_ = false;
 }
 
@@ -385,31 +453,31 @@ void lama::verifier::BytecodeVerifier::verifyLine() {
 
 void lama::verifier::BytecodeVerifier::verifyPattStr() {
     popWords(2);
-    pushWord();
+    pushWord(ValueType::INT);
 }
 
 void lama::verifier::BytecodeVerifier::verifyPatt() {
     popWord();
-    pushWord();
+    pushWord(ValueType::INT);
 }
 
 void lama::verifier::BytecodeVerifier::verifyCallLread() {
-    pushWord();
+    pushWord(ValueType::INT);
 }
 
 void lama::verifier::BytecodeVerifier::verifyCallLwrite() {
     popWord();
-    pushWord();
+    pushWord(ValueType::INT);
 }
 
 void lama::verifier::BytecodeVerifier::verifyCallLlength() {
     popWord();
-    pushWord();
+    pushWord(ValueType::INT);
 }
 
 void lama::verifier::BytecodeVerifier::verifyCallLstring() {
     popWord();
-    pushWord();
+    pushWord(ValueType::STRING);
 }
 
 void lama::verifier::BytecodeVerifier::verifyCallBarray() {
@@ -417,16 +485,33 @@ void lama::verifier::BytecodeVerifier::verifyCallBarray() {
     checkNonNegative(n, "array length must not be negative");
 
     popWords(n);
-    pushWord();
+    pushWord(ValueType::ARRAY);
 }
 
+/*
+ * A path with invalid code is abandoned and the other paths are verified further: the arity of STA is chosen
+ * from the paths verified so far, so an error may be caused by an STA which turns out to be reached
+ * by both kinds of destinations later. As for the whole file, being unverifiable takes precedence over errors
+ */
 bool lama::verifier::BytecodeVerifier::verifyBytecode() {
+    std::optional<VerificationError> firstError;
+
     while (!worklist_.empty()) {
-        if (!verifyInstruction()) {
-            return false;
+        try {
+            if (!verifyInstruction()) {
+                return false;
+            }
+        } catch (const VerificationError &error) {
+            if (!firstError) {
+                firstError = error;
+            }
         }
     }
 
+    if (firstError) {
+        throw *firstError;
+    }
+
     return true;
 }
 
@@ -436,21 +521,35 @@ bool lama::verifier::BytecodeVerifier::verifyInstruction() {
     setIp(currentState_.startIp);
     setInstructionStartOffset(getIp());
 
-    currentState_.maxStackSize = std::max(currentState_.stackSize, currentState_.maxStackSize);
+    checkCodeOffset(getInstructionStartOffset());
+
+    maxStackSize_ = std::max(currentState_.stackSize, maxStackSize_);
+
+    if (const auto it = stackSizes_.find(getInstructionStartOffset()); it != stackSizes_.end()) {
+        verifierAssert(it->second == currentState_.stackSize, "stack size inconsistency");
+
+        /*
+         * The instruction is verified again only if the abstract values have been changed,
+         * the lattice is finite, so the fixpoint is reached eventually
+         */
+        TypeState &knownTypes = typeStates_.at(getInstructionStartOffset());
 
-    if (stackSizes_.at(getInstructionStartOffset()).isDefined()) {
-        verifierAssert(
-            stackSizes_.at(getInstructionStartOffset()).getStackSize() == currentState_.stackSize,
-            "stack size inconsistency"
-        );
+        if (!knownTypes.join(currentState_.types)) {
+            return true;
+        }
 
-        return true;
+        currentState_.types = knownTypes;
     } else {
-        stackSizes_[getInstructionStartOffset()] = currentState_.stackSize;
+        stackSizes_.emplace(getInstructionStartOffset(), currentState_.stackSize);
+        typeStates_.emplace(getInstructionStartOffset(), currentState_.types);
     }
 
     pushNextState_ = true;
 
+#ifdef INTERPRETER_DEBUG
+    const std::uint32_t stackSizeBefore = currentState_.stackSize;
+#endif
+
     const lama::bytecode::InstructionOpCode op = fetchInstrOpCode();
 
     switch (op) {
@@ -482,7 +581,10 @@ bool lama::verifier::BytecodeVerifier::verifyInstruction() {
             verifySti();
             break;
         case bytecode::InstructionOpCode::STA:
-            return false;  // indicates that verifier can't completely verify the bytecode
+            if (!verifySta()) {
+                return false;  // indicates that verifier can't completely verify the bytecode
+            }
+            break;
         case bytecode::InstructionOpCode::JMP:
             verifyJmp();
             break;
@@ -503,21 +605,29 @@ bool lama::verifier::BytecodeVerifier::verifyInstruction() {
             verifyElem();
             break;
         case bytecode::InstructionOpCode::LD_G:
-        case bytecode::InstructionOpCode::LDA_G:
             verifyGlobalLoad();
             break;
+        case bytecode::InstructionOpCode::LDA_G:
+            verifyGlobalAddressLoad();
+            break;
         case bytecode::InstructionOpCode::LD_L:
-        case bytecode::InstructionOpCode::LDA_L:
             verifyLocalLoad();
             break;
+        case bytecode::InstructionOpCode::LDA_L:
+            verifyLocalAddressLoad();
+            break;
         case bytecode::InstructionOpCode::LD_A:
-        case bytecode::InstructionOpCode::LDA_A:
             verifyArgumentLoad();
             break;
+        case bytecode::InstructionOpCode::LDA_A:
+            verifyArgumentAddressLoad();
+            break;
         case bytecode::InstructionOpCode::LD_C:
-        case bytecode::InstructionOpCode::LDA_C:
             verifyCapturedLoad();
             break;
+        case bytecode::InstructionOpCode::LDA_C:
+            verifyCapturedAddressLoad();
+            break;
         case bytecode::InstructionOpCode::ST_G:
             verifyGlobalStore();
             break;
@@ -592,23 +702,429 @@ bool lama::verifier::BytecodeVerifier::verifyInstruction() {
             break;
     }
 
+#ifdef INTERPRETER_DEBUG
+    checkStackEffect(op, stackSizeBefore);
+#endif
+
     if (pushNextState_) {
-        pushState({
-            /* functionBegin = */ currentState_.functionBegin,
-            /* argsCount = */ currentState_.argsCount,
-            /* startIp = */ getIp(),
-            /* localsCount = */ currentState_.localsCount,
-            /* stackSize = */ currentState_.stackSize,
-            /* maxStackSize = */ currentState_.maxStackSize,
-            /* callstackSize = */ currentState_.callstackSize,
-        });
+        pushState(makeNextState(getIp()));
     }
 
     return true;
 }
 
-bool lama::verifier::verifyBytecodeFile(lama::bytecode::BytecodeFile *file) {
-    lama::verifier::BytecodeVerifier verifier{file};
+/* The handlers must agree with the instruction table, returns do not pop their result from the abstract stack */
+void lama::verifier::BytecodeVerifier::checkStackEffect(lama::bytecode::InstructionOpCode op, std::uint32_t stackSizeBefore) const {
+    const std::optional<lama::bytecode::decoder::StackEffect> effect = lama::bytecode::decoder::getStackEffect(
+        bytecodeFile_,
+        getInstructionStartOffset()
+    );
 
-    return verifier.verifyBytecode();
+    if (!effect || lama::bytecode::getInstructionInfo(op).isTerminal) {
+        return;
+    }
+
+    verifierAssert(
+        currentState_.stackSize + effect->pops == stackSizeBefore + effect->pushes,
+        "stack effect differs from the instruction table"
+    );
+}
+
+lama::verifier::FunctionVerificationResult lama::verifier::BytecodeVerifier::takeResult() {
+    using lama::bytecode::InstructionOpCode;
+
+    FunctionVerificationResult result{};
+    result.status = FunctionVerificationResult::Status::VERIFIED;
+    result.functionBegin = functionBegin_;
+    result.frame = {
+        /* argsCount = */ argsCount_,
+        /* localsCount = */ localsCount_,
+        /* maxStackSize = */ maxStackSize_,
+    };
+
+    result.stackSizes.assign(stackSizes_.begin(), stackSizes_.end());
+    std::sort(result.stackSizes.begin(), result.stackSizes.end());
+
+    result.blockEntries = std::move(blockEntries_);
+    std::sort(result.blockEntries.begin(), result.blockEntries.end());
+    result.blockEntries.erase(std::unique(result.blockEntries.begin(), result.blockEntries.end()), result.blockEntries.end());
+
+    result.storeDestinations.assign(storeDestinations_.begin(), storeDestinations_.end());
+    std::sort(result.storeDestinations.begin(), result.storeDestinations.end());
+
+    for (auto&& [offset, types] : typeStates_) {
+        const std::vector<ValueType> &stack = types.stack;
+        const std::size_t size = stack.size();
+
+        switch (lookupInstrOpCode(offset)) {
+            case InstructionOpCode::BINOP_ADD:
+            case InstructionOpCode::BINOP_SUB:
+            case InstructionOpCode::BINOP_MUL:
+            case InstructionOpCode::BINOP_DIV:
+            case InstructionOpCode::BINOP_MOD:
+            case InstructionOpCode::BINOP_LT:
+            case InstructionOpCode::BINOP_LE:
+            case InstructionOpCode::BINOP_GT:
+            case InstructionOpCode::BINOP_GE:
+            case InstructionOpCode::BINOP_EQ:
+            case InstructionOpCode::BINOP_NE:
+            case InstructionOpCode::BINOP_AND:
+            case InstructionOpCode::BINOP_OR:
+                result.intOperands.emplace_back(
+                    offset,
+                    size >= 2 && stack[size - 1] == ValueType::INT && stack[size - 2] == ValueType::INT
+                );
+                break;
+            case InstructionOpCode::CJMPZ:
+            case InstructionOpCode::CJMPNZ:
+                result.intOperands.emplace_back(offset, size >= 1 && stack[size - 1] == ValueType::INT);
+                break;
+            default:
+                break;
+        }
+    }
+
+    std::sort(result.intOperands.begin(), result.intOperands.end());
+
+    return result;
+}
+
+namespace {
+    using lama::verifier::FunctionVerificationResult;
+
+    /* Files with less code are verified by the calling thread only */
+    constexpr std::size_t CODE_SIZE_PER_VERIFIER_THREAD = 64 * 1024;
+
+    /*
+     * Verifies functions on a pool of threads. A worker takes newly found functions from the back
+     * of its own queue and steals from the front of the other queues when its own one is empty.
+     * The calling thread is the worker 0
+     */
+    class FunctionVerificationPool {
+    public:
+        FunctionVerificationPool(const lama::bytecode::BytecodeFile *file, std::size_t threadsNumber)
+            : file_(file)
+            , queues_(threadsNumber)
+            , pendingTasks_(0)
+            , queuedTasks_(0) {
+
+        }
+
+        std::vector<FunctionVerificationResult> run(lama::bytecode::offset_t entryPoint, std::uint32_t argsCount) {
+            schedule(0, {entryPoint, argsCount});
+
+            std::vector<std::thread> threads;
+            threads.reserve(queues_.size() - 1);
+
+            for (std::size_t worker = 1; worker < queues_.size(); ++worker) {
+                threads.emplace_back([this, worker]() { work(worker); });
+            }
+
+            work(0);
+
+            for (std::thread &thread : threads) {
+                thread.join();
+            }
+
+            return std::move(results_);
+        }
+    private:
+        struct Task {
+            lama::bytecode::offset_t functionBegin;
+            std::uint32_t argsCount;
+        };
+
+        struct TaskQueue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        const lama::bytecode::BytecodeFile *file_;
+        std::vector<TaskQueue> queues_;
+
+        // idle workers wait until a task is queued or the last pending task is verified
+        std::mutex idleMutex_;
+        std::condition_variable idle_;
+        std::size_t pendingTasks_;
+        // a task may be taken before it is counted, so the number is negative for a moment
+        std::ptrdiff_t queuedTasks_;
+
+        std::mutex scheduledMutex_;
+        std::unordered_set<lama::bytecode::offset_t> scheduled_;
+
+        std::mutex resultsMutex_;
+        std::vector<FunctionVerificationResult> results_;
+
+        void schedule(std::size_t worker, Task task) {
+            {
+                std::lock_guard lock{scheduledMutex_};
+
+                if (!scheduled_.insert(task.functionBegin).second) {
+                    return;
+                }
+            }
+
+            {
+                std::lock_guard lock{queues_[worker].mutex};
+                queues_[worker].tasks.push_back(task);
+            }
+
+            // the task is pending until it is verified, so the workers do not stop while it is queued
+            {
+                std::lock_guard lock{idleMutex_};
+                ++pendingTasks_;
+                ++queuedTasks_;
+            }
+
+            idle_.notify_one();
+        }
+
+        void countTakenTask() {
+            std::lock_guard lock{idleMutex_};
+            --queuedTasks_;
+        }
+
+        void finishTask() {
+            bool finished;
+
+            {
+                std::lock_guard lock{idleMutex_};
+                finished = --pendingTasks_ == 0;
+            }
+
+            if (finished) {
+                idle_.notify_all();
+            }
+        }
+
+        std::optional<Task> takeTask(std::size_t worker) {
+            {
+                TaskQueue &own = queues_[worker];
+                std::lock_guard lock{own.mutex};
+
+                if (!own.tasks.empty()) {
+                    const Task task = own.tasks.back();
+                    own.tasks.pop_back();
+
+                    countTakenTask();
+
+                    return task;
+                }
+            }
+
+            for (std::size_t i = 1; i < queues_.size(); ++i) {
+                TaskQueue &victim = queues_[(worker + i) % queues_.size()];
+                std::lock_guard lock{victim.mutex};
+
+                if (!victim.tasks.empty()) {
+                    const Task task = victim.tasks.front();
+                    victim.tasks.pop_front();
+
+                    countTakenTask();
+
+                    return task;
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        void work(std::size_t worker) {
+            while (true) {
+                const std::optional<Task> task = takeTask(worker);
+
+                if (!task) {
+                    std::unique_lock lock{idleMutex_};
+                    idle_.wait(lock, [this]() { return queuedTasks_ > 0 || pendingTasks_ == 0; });
+
+                    if (pendingTasks_ == 0) {
+                        return;
+                    }
+
+                    continue;
+                }
+
+                FunctionVerificationResult result = lama::verifier::verifyFunction(
+                    file_,
+                    task->functionBegin,
+                    task->argsCount,
+                    [this, worker](lama::bytecode::offset_t functionBegin, std::uint32_t argsCount) {
+                        schedule(worker, {functionBegin, argsCount});
+                    }
+                );
+
+                {
+                    std::lock_guard lock{resultsMutex_};
+                    results_.push_back(std::move(result));
+                }
+
+                finishTask();
+            }
+        }
+    };
+
+    std::size_t getVerifierThreadsNumber(std::size_t codeSize) {
+        std::size_t threadsNumber = lama::verifier::VERIFIER_THREADS;
+
+        if (threadsNumber == 0) {
+            threadsNumber = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        return std::min(threadsNumber, codeSize / CODE_SIZE_PER_VERIFIER_THREAD + 1);
+    }
+}
+
+lama::verifier::FunctionVerificationResult lama::verifier::verifyFunction(
+    const lama::bytecode::BytecodeFile *file,
+    lama::bytecode::offset_t functionBegin,
+    std::uint32_t argsCount,
+    BytecodeVerifier::FunctionFoundCallback functionFound
+) {
+    BytecodeVerifier verifier{file, functionBegin, argsCount, std::move(functionFound)};
+
+    FunctionVerificationResult result{};
+    result.functionBegin = functionBegin;
+
+    try {
+        if (!verifier.verifyBytecode()) {
+            result.status = FunctionVerificationResult::Status::UNVERIFIABLE;
+
+            return result;
+        }
+    } catch (const VerificationError &error) {
+        result.status = FunctionVerificationResult::Status::INVALID;
+        result.error = error;
+
+        return result;
+    }
+
+    return verifier.takeResult();
+}
+
+lama::verifier::VerificationMerger::VerificationMerger(const lama::bytecode::BytecodeFile *file)
+    : stackSizes_(file->getCodeSize(), NO_STACK_SIZE)
+    , intOperands_(file->getCodeSize(), IntOperands::UNKNOWN)
+    , merged_(file->getCodeSize()) {
+
+}
+
+bool lama::verifier::VerificationMerger::merge(const FunctionVerificationResult &function) {
+    lama::interpreter::TypeFacts &facts = merged_.getTypeFacts();
+
+    merged_.updateFunction(function.functionBegin, function.frame);
+
+    for (auto&& [offset, stackSize] : function.stackSizes) {
+        if (stackSizes_[offset] != NO_STACK_SIZE && stackSizes_[offset] != stackSize) {
+            throw VerificationError{offset, "stack size inconsistency"};
+        }
+
+        stackSizes_[offset] = stackSize;
+    }
+
+    for (lama::bytecode::offset_t offset : function.blockEntries) {
+        if (stackSizes_[offset] != NO_STACK_SIZE) {
+            merged_.setBlockEntryDepth(offset, stackSizes_[offset]);
+        }
+    }
+
+    for (auto&& [offset, proven] : function.intOperands) {
+        if (intOperands_[offset] != IntOperands::NOT_PROVEN) {
+            intOperands_[offset] = proven ? IntOperands::PROVEN : IntOperands::NOT_PROVEN;
+        }
+    }
+
+    for (auto&& [offset, destination] : function.storeDestinations) {
+        const StoreDestination known = facts.getStoreDestination(offset);
+
+        if (known != StoreDestination::UNKNOWN && known != destination) {
+            return false;
+        }
+
+        facts.setStoreDestination(offset, destination);
+    }
+
+    return true;
+}
+
+lama::interpreter::VerificationResult lama::verifier::VerificationMerger::takeResult() {
+    lama::interpreter::TypeFacts &facts = merged_.getTypeFacts();
+
+    for (lama::bytecode::offset_t offset = 0; offset < intOperands_.size(); ++offset) {
+        if (intOperands_[offset] == IntOperands::PROVEN) {
+            facts.setIntOperands(offset);
+        }
+    }
+
+    merged_.setVerified(true);
+
+    return std::move(merged_);
+}
+
+void lama::verifier::reportVerificationError(const lama::bytecode::BytecodeFile *file, const VerificationError &error) {
+    ::failure(
+        const_cast<char *>("verification error (file: %s, code offset: %" PRIdAI "): %s\n"),
+        file->getFilePath().data(),
+        error.offset,
+        error.message.data()
+    );
+}
+
+bool lama::verifier::verifyBytecodeFile(const lama::bytecode::BytecodeFile *file, lama::interpreter::VerificationResult *result) {
+    FunctionVerificationPool pool{file, getVerifierThreadsNumber(file->getCodeSize())};
+
+    std::vector<FunctionVerificationResult> functions = pool.run(
+        static_cast<lama::bytecode::offset_t>(file->getEntryPointOffset()),
+        lama::runtime::MAIN_FUNCTION_ARGUMENTS
+    );
+
+    // the functions are verified in any order, they are merged in the order of the code
+    std::sort(functions.begin(), functions.end(), [](const FunctionVerificationResult &lhs, const FunctionVerificationResult &rhs) {
+        return lhs.functionBegin < rhs.functionBegin;
+    });
+
+    const auto hasStatus = [&functions](FunctionVerificationResult::Status status) {
+        return std::any_of(functions.begin(), functions.end(), [status](const FunctionVerificationResult &function) {
+            return function.status == status;
+        });
+    };
+
+    /*
+     * An unverifiable function makes the whole file to be executed with dynamic checks, which also catch
+     * the errors of invalid functions. Otherwise the error of the first invalid function is reported
+     */
+    const auto fail = [result]() {
+        if (result != nullptr) {
+            *result = lama::interpreter::VerificationResult{};
+        }
+
+        return false;
+    };
+
+    if (hasStatus(FunctionVerificationResult::Status::UNVERIFIABLE)) {
+        return fail();
+    }
+
+    for (const FunctionVerificationResult &function : functions) {
+        if (function.status == FunctionVerificationResult::Status::INVALID) {
+            reportVerificationError(file, function.error);
+        }
+    }
+
+    VerificationMerger merger{file};
+
+    for (const FunctionVerificationResult &function : functions) {
+        try {
+            if (!merger.merge(function)) {
+                return fail();  // both kinds of destinations reach the instruction, so its arity is known at runtime only
+            }
+        } catch (const VerificationError &error) {
+            reportVerificationError(file, error);
+        }
+    }
+
+    if (result != nullptr) {
+        *result = merger.takeResult();
+    }
+
+    return true;
 }
@@ -2,62 +2,99 @@
 #define INTERPRETER_VERIFIER_HPP
 
 #include <cstdint>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "interpreter.hpp"
 #include "lama_runtime.hpp"
+#include "type_facts.hpp"
+#include "verification_result.hpp"
 
 #include "../bytecode/source_file.hpp"
 
+#ifndef LAMA_VERIFIER_THREADS
+#define LAMA_VERIFIER_THREADS 0
+#endif
+
 namespace lama::verifier {
+constexpr std::size_t VERIFIER_THREADS = LAMA_VERIFIER_THREADS;
+
+using lama::interpreter::StoreDestination;
+using lama::interpreter::ValueType;
+
+/*
+ * Abstract values of the operand stack frame and of the local variables.
+ * A local is escaped once its address is taken by LDA, after that it may be changed
+ * through the reference, so its type is unknown until the function returns
+ */
+struct TypeState {
+    std::vector<ValueType> stack;
+    std::vector<ValueType> locals;
+    std::vector<bool> escapedLocals;
+
+    /* Returns true if this state has been changed */
+    bool join(const TypeState &other);
+};
+
 struct VerifierAbstractState {
-    lama::bytecode::offset_t functionBegin;
-    std::uint16_t argsCount;
     lama::bytecode::offset_t startIp;
-    std::uint16_t localsCount;
-    std::uint16_t stackSize;
-    std::uint16_t maxStackSize;
-    std::uint16_t callstackSize;
+    std::uint32_t localsCount;
+    std::uint32_t stackSize;
+    TypeState types;
 };
 
-class StackSize {
-public:
-    StackSize()
-        : defined_(false)
-        , stackSize_(0) {
-
-    }
-
-    StackSize(std::size_t stackSize)
-        : defined_(true)
-        , stackSize_(stackSize) {
-
-    }
-
-    bool isDefined() const {
-        return defined_;
-    }
-
-    void setStackSize(std::size_t stackSize) {
-        stackSize_ = stackSize;
-        defined_ = true;
-    }
+/* Thrown by the verifier on invalid code, reported once all the functions are verified */
+struct VerificationError {
+    lama::bytecode::offset_t offset;
+    std::string_view message;
+};
 
-    std::size_t getStackSize() const {
-        return stackSize_;
-    }
-private:
-    bool defined_;
-    std::size_t stackSize_;
+/*
+ * Everything the verifier has found out about a single function, the results of all functions
+ * are merged into a VerificationResult. Facts are sorted by code offset
+ */
+struct FunctionVerificationResult {
+    enum class Status {
+        VERIFIED,
+        UNVERIFIABLE,
+        INVALID,
+    };
+
+    Status status;
+    lama::bytecode::offset_t functionBegin;
+    lama::interpreter::FunctionFrameInfo frame;
+    std::vector<std::pair<lama::bytecode::offset_t, std::uint32_t>> stackSizes;
+    std::vector<lama::bytecode::offset_t> blockEntries;
+    std::vector<std::pair<lama::bytecode::offset_t, bool>> intOperands;
+    std::vector<std::pair<lama::bytecode::offset_t, StoreDestination>> storeDestinations;
+    VerificationError error;
 };
 
+/*
+ * Verifies a single function starting from its entry, callees are not followed but reported
+ * to functionFound with the number of arguments they are called with
+ */
 class BytecodeVerifier {
 public:
-    BytecodeVerifier(lama::bytecode::BytecodeFile *bytecodeFile);
+    using FunctionFoundCallback = std::function<void(lama::bytecode::offset_t functionBegin, std::uint32_t argsCount)>;
+
+    BytecodeVerifier(
+        const lama::bytecode::BytecodeFile *bytecodeFile,
+        lama::bytecode::offset_t functionBegin,
+        std::uint32_t argsCount,
+        FunctionFoundCallback functionFound
+    );
 
+    /* Returns false if the function cannot be verified completely, throws VerificationError if its code is invalid */
     bool verifyBytecode();
     bool verifyInstruction();
 
+    /* Must be called after successful verification only, the verifier must not be used after that */
+    FunctionVerificationResult takeResult();
+
     lama::bytecode::offset_t getIp() const {
         return ip_;
     }
@@ -119,29 +156,60 @@ protected:
     void pushWords(std::size_t words) {
         checkStackOverflow(words);
         currentState_.stackSize += words;
+        currentState_.types.stack.resize(currentState_.stackSize, ValueType::UNKNOWN);
     }
 
-    void pushWord() {
+    void pushWord(ValueType type = ValueType::UNKNOWN) {
         pushWords(1);
+        setTopType(type);
     }
 
     void popWords(std::size_t words) {
         checkStackUnderflow(words);
         currentState_.stackSize -= words;
+        currentState_.types.stack.resize(currentState_.stackSize);
     }
 
     void popWord() {
         popWords(1);
     }
 
-    void pushFrame() {
-        verifierAssert(currentState_.callstackSize < lama::interpreter::CALLSTACK_CAPACITY, "callstack exhausted");
-        currentState_.callstackSize++;
+    ValueType peekType(std::size_t offset = 1) const {
+        checkStackUnderflow(offset);
+
+        return currentState_.types.stack[currentState_.stackSize - offset];
+    }
+
+    void setTopType(ValueType type, std::size_t offset = 1) {
+        currentState_.types.stack[currentState_.stackSize - offset] = type;
+    }
+
+    ValueType getLocalType(std::uint32_t index) const {
+        const TypeState &types = currentState_.types;
+
+        return index < types.locals.size() && !types.escapedLocals[index]
+            ? types.locals[index]
+            : ValueType::UNKNOWN;
     }
 
-    void popFrame() {
-        verifierAssert(currentState_.callstackSize > 0, "callstack is empty");
-        --currentState_.callstackSize;
+    void setLocalType(std::uint32_t index, ValueType type) {
+        if (index < currentState_.types.locals.size()) {
+            currentState_.types.locals[index] = type;
+        }
+    }
+
+    void escapeLocal(std::uint32_t index) {
+        if (index < currentState_.types.escapedLocals.size()) {
+            currentState_.types.escapedLocals[index] = true;
+        }
+    }
+
+    /* Successor states inherit the abstract values of the current one */
+    VerifierAbstractState makeNextState(lama::bytecode::offset_t startIp) const {
+        VerifierAbstractState state = currentState_;
+        state.startIp = startIp;
+
+        return state;
     }
 
     void pushState(const VerifierAbstractState &state) {
@@ -170,6 +238,7 @@ protected:
     void verifySexp();
 
     void verifySti();
+    bool verifySta();
 
     void verifyJmp();
 
@@ -186,6 +255,11 @@ protected:
     void verifyArgumentLoad();
     void verifyCapturedLoad();
 
+    void verifyGlobalAddressLoad();
+    void verifyLocalAddressLoad();
+    void verifyArgumentAddressLoad();
+    void verifyCapturedAddressLoad();
+
     void verifyGlobalStore();
     void verifyLocalStore();
     void verifyArgumentStore();
@@ -217,11 +291,19 @@ protected:
 private:
     lama::bytecode::offset_t ip_;
     lama::bytecode::offset_t instructionStartOffset_;
-    std::vector<StackSize> stackSizes_;
+    const lama::bytecode::offset_t functionBegin_;
+    const std::uint32_t argsCount_;
+    std::uint32_t localsCount_;
+    std::uint32_t maxStackSize_;
+    std::unordered_map<lama::bytecode::offset_t, std::uint32_t> stackSizes_;
+    std::unordered_map<lama::bytecode::offset_t, TypeState> typeStates_;
+    std::unordered_map<lama::bytecode::offset_t, StoreDestination> storeDestinations_;
+    std::vector<lama::bytecode::offset_t> blockEntries_;
+    FunctionFoundCallback functionFound_;
     VerifierAbstractState currentState_;
     std::vector<VerifierAbstractState> worklist_;
     bool pushNextState_;
-    lama::bytecode::BytecodeFile *bytecodeFile_;
+    const lama::bytecode::BytecodeFile *bytecodeFile_;
 
     void setIp(lama::bytecode::offset_t newIp) {
         ip_ = newIp;
@@ -235,7 +317,12 @@ private:
         instructionStartOffset_ = offset;
     }
 
-    void saveStackSizeInfo(bytecode::offset_t offset, std::uint16_t stackSize, std::uint16_t localsNum);
+    /* Returns the declared number of arguments of the function */
+    std::uint32_t checkFunctionBegin(lama::bytecode::offset_t functionBegin, std::string_view message) const;
+
+    void markBlockEntry(lama::bytecode::offset_t offset) {
+        blockEntries_.push_back(offset);
+    }
 
     void checkGlobalValueIndex(lama::bytecode::offset_t globalValueIndex) const {
         verifierAssert(globalValueIndex < bytecodeFile_->getGlobalAreaSize(), "global value index out of range");
@@ -247,10 +334,11 @@ private:
 
     void checkLocalsNumber(std::int32_t localsNum) const {
         checkNonNegative(localsNum, "locals number must not be negative");
+        verifierAssert(static_cast<std::size_t>(localsNum) < lama::interpreter::OP_STACK_CAPACITY, "operand stack exhausted");
     }
 
-    void checkArgumentValueIndex(const VerifierAbstractState &state, std::uint32_t index) {
-        verifierAssert(index < state.argsCount, "argument value index out of range");
+    void checkArgumentValueIndex(std::uint32_t index) const {
+        verifierAssert(index < argsCount_, "argument value index out of range");
     }
 
     void checkArgumentsNumber(std::int32_t argsNum) const {
@@ -281,23 +369,76 @@ private:
         verifierAssert(currentState_.stackSize + words < lama::interpreter::OP_STACK_CAPACITY, "operand stack exhausted");
     }
 
+    void checkStackEffect(lama::bytecode::InstructionOpCode op, std::uint32_t stackSizeBefore) const;
+
     void checkCodeOffset(lama::bytecode::offset_t offset) const {
         verifierAssert(offset < bytecodeFile_->getCodeSize(), "code offset out of range");
     }
 
     void verifierAssert(bool condition, std::string_view message) const {
         if (!condition) {
-            ::failure(
-                const_cast<char *>("verification error (file: %s, code offset: %" PRIdAI "): %s\n"),
-                bytecodeFile_->getFilePath().data(),
-                getInstructionStartOffset(),
-                message.data()
-             );
+            throw VerificationError{getInstructionStartOffset(), message};
         }
     }
 };
 
-bool verifyBytecodeFile(bytecode::BytecodeFile *file);
+/* Verifies a single function, its callees are reported to functionFound */
+FunctionVerificationResult verifyFunction(
+    const lama::bytecode::BytecodeFile *file,
+    lama::bytecode::offset_t functionBegin,
+    std::uint32_t argsCount,
+    BytecodeVerifier::FunctionFoundCallback functionFound
+);
+
+/*
+ * Merges the results of independently verified functions. The same code may be shared by several functions,
+ * so the facts must hold for all of them: the operands are integers only if every function proves it
+ */
+class VerificationMerger {
+public:
+    explicit VerificationMerger(const lama::bytecode::BytecodeFile *file);
+
+    /*
+     * The function must be verified. Returns false if both kinds of destinations reach the same STA,
+     * so its arity is known at runtime only. Throws VerificationError on inconsistent stack sizes
+     */
+    bool merge(const FunctionVerificationResult &function);
+
+    bool hasIntOperands(lama::bytecode::offset_t offset) const {
+        return intOperands_[offset] == IntOperands::PROVEN;
+    }
+
+    /* The functions merged so far, integer operands are not stored until the result is taken */
+    const lama::interpreter::VerificationResult& getResult() const {
+        return merged_;
+    }
+
+    /* The merger must not be used after that */
+    lama::interpreter::VerificationResult takeResult();
+private:
+    enum class IntOperands : unsigned char {
+        UNKNOWN,
+        PROVEN,
+        NOT_PROVEN,
+    };
+
+    static constexpr std::uint32_t NO_STACK_SIZE = ~std::uint32_t{0};
+
+    std::vector<std::uint32_t> stackSizes_;
+    std::vector<IntOperands> intOperands_;
+    lama::interpreter::VerificationResult merged_;
+};
+
+[[noreturn]] void reportVerificationError(const lama::bytecode::BytecodeFile *file, const VerificationError &error);
+
+/*
+ * Functions reachable from the entry point through CALL and CLOSURE are verified independently
+ * by a pool of threads, LAMA_VERIFIER_THREADS limits its size (0 means the number of hardware threads).
+ * Small files are verified by the calling thread only.
+ * The result is stored to result if it is not null, the file is never modified.
+ * On failure the stored result is not verified
+ */
+bool verifyBytecodeFile(const bytecode::BytecodeFile *file, lama::interpreter::VerificationResult *result = nullptr);
 }
 
 #endif
@@ -0,0 +1,36 @@
+#include "executable_memory.hpp"
+
+#include "template_jit.hpp"
+
+#ifdef LAMA_JIT
+#include <cstring>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "../interpreter/lama_runtime.hpp"
+
+lama::jit::ExecutableMemory::ExecutableMemory(const std::vector<std::uint8_t> &code) {
+    const std::size_t pageSize = ::sysconf(_SC_PAGESIZE);
+
+    size_ = (code.size() + pageSize - 1) / pageSize * pageSize;
+
+    void *memory = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (memory == MAP_FAILED) {
+        ::failure(const_cast<char *>("cannot allocate memory for native code\n"));
+    }
+
+    std::memcpy(memory, code.data(), code.size());
+
+    if (::mprotect(memory, size_, PROT_READ | PROT_EXEC) != 0) {
+        ::failure(const_cast<char *>("cannot make native code executable\n"));
+    }
+
+    memory_ = static_cast<std::uint8_t *>(memory);
+}
+
+lama::jit::ExecutableMemory::~ExecutableMemory() {
+    ::munmap(memory_, size_);
+}
+#endif
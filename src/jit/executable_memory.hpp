@@ -0,0 +1,26 @@
+#ifndef JIT_EXECUTABLE_MEMORY_HPP
+#define JIT_EXECUTABLE_MEMORY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lama::jit {
+/* Page-aligned memory with the copy of the given code, it is never writable and executable at the same time */
+class ExecutableMemory {
+public:
+    ExecutableMemory(const std::vector<std::uint8_t> &code);
+    ExecutableMemory(const ExecutableMemory &other) = delete;
+    ExecutableMemory(ExecutableMemory&& other) = delete;
+    ~ExecutableMemory();
+
+    const std::uint8_t* data() const {
+        return memory_;
+    }
+private:
+    std::uint8_t *memory_;
+    std::size_t size_;
+};
+}
+
+#endif
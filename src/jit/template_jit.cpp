@@ -0,0 +1,479 @@
+#include "template_jit.hpp"
+
+#ifdef LAMA_JIT
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "../bytecode/bytecode_instructions.hpp"
+#include "../interpreter/lama_runtime.hpp"
+
+#include "x86_64_assembler.hpp"
+
+namespace {
+    using lama::bytecode::InstructionOpCode;
+    using lama::interpreter::DecodedInstruction;
+    using lama::interpreter::instr_index_t;
+    using lama::jit::Condition;
+    using lama::jit::Register;
+    using lama::jit::X86_64Assembler;
+
+    /*
+     * Registers of native code, all of them are callee-saved, so they survive helper calls:
+     * the context, the end of the operand stack, the locals and the arguments of the current frame
+     */
+    constexpr Register CONTEXT_REG = Register::RBX;
+    constexpr Register SP_REG = Register::R12;
+    constexpr Register LOCALS_REG = Register::R13;
+    constexpr Register ARGS_REG = Register::R14;
+
+    constexpr std::int32_t WORD_SIZE = sizeof(lama::runtime::Word);
+
+    /* Boxed integers are odd, boxed zero is 1 */
+    constexpr std::int32_t BOXED_ZERO = 1;
+
+    class TemplateCompiler {
+    public:
+        TemplateCompiler(
+            const lama::interpreter::InstructionStream *code,
+            const lama::runtime::Word *globals,
+            const void *helper
+        )   : code_(code)
+            , globals_(globals)
+            , helper_(helper)
+            , positions_(code->size()) {
+
+        }
+
+        void compile();
+
+        const std::vector<std::uint8_t>& getCode() const {
+            return asm_.getCode();
+        }
+
+        X86_64Assembler::position_t getEntryPosition() const {
+            return entryPosition_;
+        }
+
+        X86_64Assembler::position_t getExitPosition() const {
+            return exitPosition_;
+        }
+
+        X86_64Assembler::position_t getInstructionPosition(instr_index_t index) const {
+            return positions_[index];
+        }
+    private:
+        const lama::interpreter::InstructionStream *code_;
+        const lama::runtime::Word *globals_;
+        const void *helper_;
+        X86_64Assembler asm_;
+        std::vector<X86_64Assembler::position_t> positions_;
+        std::vector<std::pair<X86_64Assembler::position_t, instr_index_t>> jumps_;
+        X86_64Assembler::position_t entryPosition_ = 0;
+        X86_64Assembler::position_t exitPosition_ = 0;
+
+        void emitEntry();
+        void emitExit();
+
+        void emitInstruction(instr_index_t index, const DecodedInstruction &instr);
+        void emitHelperCall(instr_index_t index);
+
+        void emitPush(Register reg);
+        void emitIntBinop(instr_index_t index, InstructionOpCode opcode, bool checked);
+        void emitConditionalJmp(instr_index_t index, const DecodedInstruction &instr, Condition jumpIf, bool checked);
+
+        void emitJmp(instr_index_t target) {
+            jumps_.push_back({asm_.jmpRel32(), target});
+        }
+
+        void emitJcc(Condition cond, instr_index_t target) {
+            jumps_.push_back({asm_.jccRel32(cond), target});
+        }
+
+        void loadGcStackBottom(Register dst, Register scratch) {
+            asm_.movImm64(scratch, reinterpret_cast<std::uint64_t>(&__gc_stack_bottom));
+            asm_.movLoad(dst, scratch, 0);
+        }
+
+        void storeGcStackBottom(Register src, Register scratch) {
+            asm_.movImm64(scratch, reinterpret_cast<std::uint64_t>(&__gc_stack_bottom));
+            asm_.movStore(scratch, 0, src);
+        }
+
+        void loadFrameRegisters() {
+            asm_.movLoad(LOCALS_REG, CONTEXT_REG, offsetof(lama::jit::NativeContext, locals));
+            asm_.movLoad(ARGS_REG, CONTEXT_REG, offsetof(lama::jit::NativeContext, args));
+        }
+    };
+
+    /* void entry(NativeContext *context, const void *address) */
+    void TemplateCompiler::emitEntry() {
+        entryPosition_ = asm_.getPosition();
+
+        asm_.push(Register::RBX);
+        asm_.push(Register::RBP);
+        asm_.push(Register::R12);
+        asm_.push(Register::R13);
+        asm_.push(Register::R14);
+        asm_.push(Register::R15);
+        asm_.subImm(Register::RSP, 8); // the stack must be 16-byte aligned at helper calls
+
+        asm_.mov(CONTEXT_REG, Register::RDI);
+        loadGcStackBottom(SP_REG, Register::RAX);
+        loadFrameRegisters();
+
+        asm_.jmp(Register::RSI);
+    }
+
+    void TemplateCompiler::emitExit() {
+        exitPosition_ = asm_.getPosition();
+
+        storeGcStackBottom(SP_REG, Register::RAX);
+
+        asm_.addImm(Register::RSP, 8);
+        asm_.pop(Register::R15);
+        asm_.pop(Register::R14);
+        asm_.pop(Register::R13);
+        asm_.pop(Register::R12);
+        asm_.pop(Register::RBP);
+        asm_.pop(Register::RBX);
+        asm_.ret();
+    }
+
+    /* The helper executes the instruction and returns the native address to continue from */
+    void TemplateCompiler::emitHelperCall(instr_index_t index) {
+        storeGcStackBottom(SP_REG, Register::RAX);
+
+        asm_.mov(Register::RDI, CONTEXT_REG);
+        asm_.movImm64(Register::RSI, index);
+        asm_.movImm64(Register::RAX, reinterpret_cast<std::uint64_t>(helper_));
+        asm_.call(Register::RAX);
+
+        loadGcStackBottom(SP_REG, Register::RCX);
+        loadFrameRegisters();
+
+        asm_.jmp(Register::RAX);
+    }
+
+    void TemplateCompiler::emitPush(Register reg) {
+        asm_.movStore(SP_REG, 0, reg);
+        asm_.addImm(SP_REG, WORD_SIZE);
+    }
+
+    /*
+     * Operands are boxed integers 2x + 1, the results are computed without unboxing where possible.
+     * Unless the operands are proven to be integers, their tags are checked and the instruction
+     * is executed by the interpreter handler on mismatch to report the error
+     */
+    void TemplateCompiler::emitIntBinop(instr_index_t index, InstructionOpCode opcode, bool checked) {
+        asm_.movLoad(Register::RAX, SP_REG, -2 * WORD_SIZE);
+        asm_.movLoad(Register::RCX, SP_REG, -WORD_SIZE);
+
+        X86_64Assembler::position_t slowPath = 0;
+
+        if (checked) {
+            asm_.mov(Register::RDX, Register::RAX);
+            asm_.and_(Register::RDX, Register::RCX);
+            asm_.testImm(Register::RDX, 1);
+            slowPath = asm_.jccRel32(Condition::EQUAL);
+        }
+
+        const auto emitComparison = [this](Condition cond) {
+            asm_.cmp(Register::RAX, Register::RCX);
+            asm_.setcc(cond, Register::RAX);
+            asm_.movzxByte(Register::RAX, Register::RAX);
+            asm_.add(Register::RAX, Register::RAX);
+            asm_.orImm(Register::RAX, 1);
+        };
+
+        switch (opcode) {
+            case InstructionOpCode::BINOP_ADD:
+                asm_.add(Register::RAX, Register::RCX);
+                asm_.subImm(Register::RAX, 1);
+                break;
+            case InstructionOpCode::BINOP_SUB:
+                asm_.sub(Register::RAX, Register::RCX);
+                asm_.addImm(Register::RAX, 1);
+                break;
+            case InstructionOpCode::BINOP_MUL:
+                asm_.sar1(Register::RAX);
+                asm_.subImm(Register::RCX, 1);
+                asm_.imul(Register::RAX, Register::RCX);
+                asm_.orImm(Register::RAX, 1);
+                break;
+            case InstructionOpCode::BINOP_LT:
+                emitComparison(Condition::LESS);
+                break;
+            case InstructionOpCode::BINOP_LE:
+                emitComparison(Condition::LESS_OR_EQUAL);
+                break;
+            case InstructionOpCode::BINOP_GT:
+                emitComparison(Condition::GREATER);
+                break;
+            case InstructionOpCode::BINOP_GE:
+                emitComparison(Condition::GREATER_OR_EQUAL);
+                break;
+            case InstructionOpCode::BINOP_EQ:
+                emitComparison(Condition::EQUAL);
+                break;
+            case InstructionOpCode::BINOP_NE:
+                emitComparison(Condition::NOT_EQUAL);
+                break;
+            case InstructionOpCode::BINOP_AND:
+                asm_.cmpImm(Register::RAX, BOXED_ZERO);
+                asm_.setcc(Condition::NOT_EQUAL, Register::RAX);
+                asm_.cmpImm(Register::RCX, BOXED_ZERO);
+                asm_.setcc(Condition::NOT_EQUAL, Register::RCX);
+                asm_.andByte(Register::RAX, Register::RCX);
+                asm_.movzxByte(Register::RAX, Register::RAX);
+                asm_.add(Register::RAX, Register::RAX);
+                asm_.orImm(Register::RAX, 1);
+                break;
+            case InstructionOpCode::BINOP_OR:
+                // both operands are odd, so their bitwise or is 1 iff both of them are zeros
+                asm_.or_(Register::RAX, Register::RCX);
+                asm_.cmpImm(Register::RAX, BOXED_ZERO);
+                asm_.setcc(Condition::NOT_EQUAL, Register::RAX);
+                asm_.movzxByte(Register::RAX, Register::RAX);
+                asm_.add(Register::RAX, Register::RAX);
+                asm_.orImm(Register::RAX, 1);
+                break;
+            default:
+                break;
+        }
+
+        asm_.movStore(SP_REG, -2 * WORD_SIZE, Register::RAX);
+        asm_.subImm(SP_REG, WORD_SIZE);
+
+        if (checked) {
+            const X86_64Assembler::position_t done = asm_.jmpRel32();
+
+            asm_.patchRel32(slowPath, asm_.getPosition());
+            emitHelperCall(index);
+            asm_.patchRel32(done, asm_.getPosition());
+        }
+    }
+
+    void TemplateCompiler::emitConditionalJmp(
+        instr_index_t index,
+        const DecodedInstruction &instr,
+        Condition jumpIf,
+        bool checked
+    ) {
+        asm_.movLoad(Register::RAX, SP_REG, -WORD_SIZE);
+
+        X86_64Assembler::position_t slowPath = 0;
+
+        if (checked) {
+            asm_.testImm(Register::RAX, 1);
+            slowPath = asm_.jccRel32(Condition::EQUAL);
+        }
+
+        asm_.subImm(SP_REG, WORD_SIZE);
+        asm_.cmpImm(Register::RAX, BOXED_ZERO);
+        emitJcc(jumpIf, instr.operand0);
+
+        if (checked) {
+            const X86_64Assembler::position_t done = asm_.jmpRel32();
+
+            asm_.patchRel32(slowPath, asm_.getPosition());
+            emitHelperCall(index);
+            asm_.patchRel32(done, asm_.getPosition());
+        }
+    }
+
+    void TemplateCompiler::emitInstruction(instr_index_t index, const DecodedInstruction &instr) {
+        namespace quick_opcode = lama::interpreter::quick_opcode;
+
+        switch (instr.opcode) {
+            case InstructionOpCode::BINOP_ADD:
+            case InstructionOpCode::BINOP_SUB:
+            case InstructionOpCode::BINOP_MUL:
+            case InstructionOpCode::BINOP_LT:
+            case InstructionOpCode::BINOP_LE:
+            case InstructionOpCode::BINOP_GT:
+            case InstructionOpCode::BINOP_GE:
+            case InstructionOpCode::BINOP_NE:
+            case InstructionOpCode::BINOP_AND:
+            case InstructionOpCode::BINOP_OR:
+                emitIntBinop(index, instr.opcode, true);
+                break;
+            case quick_opcode::BINOP_ADD:
+            case quick_opcode::BINOP_SUB:
+            case quick_opcode::BINOP_MUL:
+            case quick_opcode::BINOP_LT:
+            case quick_opcode::BINOP_LE:
+            case quick_opcode::BINOP_GT:
+            case quick_opcode::BINOP_GE:
+            case quick_opcode::BINOP_EQ:
+            case quick_opcode::BINOP_NE:
+            case quick_opcode::BINOP_AND:
+            case quick_opcode::BINOP_OR:
+                emitIntBinop(index, quick_opcode::getBinopOpcode(instr.opcode), false);
+                break;
+            case InstructionOpCode::CJMPZ:
+                emitConditionalJmp(index, instr, Condition::EQUAL, true);
+                break;
+            case InstructionOpCode::CJMPNZ:
+                emitConditionalJmp(index, instr, Condition::NOT_EQUAL, true);
+                break;
+            case quick_opcode::CJMPZ:
+                emitConditionalJmp(index, instr, Condition::EQUAL, false);
+                break;
+            case quick_opcode::CJMPNZ:
+                emitConditionalJmp(index, instr, Condition::NOT_EQUAL, false);
+                break;
+            case InstructionOpCode::CONST:
+                asm_.movImm64(Register::RAX, instr.operand0);
+                emitPush(Register::RAX);
+                break;
+            case InstructionOpCode::JMP:
+                emitJmp(instr.operand0);
+                break;
+            case InstructionOpCode::DROP:
+                asm_.subImm(SP_REG, WORD_SIZE);
+                break;
+            case InstructionOpCode::DUP:
+                asm_.movLoad(Register::RAX, SP_REG, -WORD_SIZE);
+                emitPush(Register::RAX);
+                break;
+            case InstructionOpCode::SWAP:
+                asm_.movLoad(Register::RAX, SP_REG, -WORD_SIZE);
+                asm_.movLoad(Register::RCX, SP_REG, -2 * WORD_SIZE);
+                asm_.movStore(SP_REG, -WORD_SIZE, Register::RCX);
+                asm_.movStore(SP_REG, -2 * WORD_SIZE, Register::RAX);
+                break;
+            case InstructionOpCode::LD_G:
+                asm_.movImm64(Register::RCX, reinterpret_cast<std::uint64_t>(globals_ + instr.operand0));
+                asm_.movLoad(Register::RAX, Register::RCX, 0);
+                emitPush(Register::RAX);
+                break;
+            case InstructionOpCode::LD_L:
+                asm_.movLoad(Register::RAX, LOCALS_REG, instr.operand0 * WORD_SIZE);
+                emitPush(Register::RAX);
+                break;
+            case InstructionOpCode::LD_A:
+                asm_.movLoad(Register::RAX, ARGS_REG, instr.operand0 * WORD_SIZE);
+                emitPush(Register::RAX);
+                break;
+            case InstructionOpCode::ST_G:
+                asm_.movLoad(Register::RAX, SP_REG, -WORD_SIZE);
+                asm_.movImm64(Register::RCX, reinterpret_cast<std::uint64_t>(globals_ + instr.operand0));
+                asm_.movStore(Register::RCX, 0, Register::RAX);
+                break;
+            case InstructionOpCode::ST_L:
+                asm_.movLoad(Register::RAX, SP_REG, -WORD_SIZE);
+                asm_.movStore(LOCALS_REG, instr.operand0 * WORD_SIZE, Register::RAX);
+                break;
+            case InstructionOpCode::ST_A:
+                asm_.movLoad(Register::RAX, SP_REG, -WORD_SIZE);
+                asm_.movStore(ARGS_REG, instr.operand0 * WORD_SIZE, Register::RAX);
+                break;
+            case InstructionOpCode::LINE:
+                break;
+            default:
+                emitHelperCall(index);
+                break;
+        }
+    }
+
+    void TemplateCompiler::compile() {
+        emitEntry();
+        emitExit();
+
+        /*
+         * Functions are laid out in the order of the instruction stream, every instruction
+         * gets its own native address, since calls, returns and jumps of the helpers may
+         * continue from any of them
+         */
+        for (instr_index_t i = 0; i < code_->size(); ++i) {
+            positions_[i] = asm_.getPosition();
+            emitInstruction(i, (*code_)[i]);
+        }
+
+        for (auto&& [dispPosition, target] : jumps_) {
+            asm_.patchRel32(dispPosition, positions_[target]);
+        }
+    }
+}
+
+lama::jit::NativeCodeState::NativeCodeState(
+    const lama::bytecode::BytecodeFile *bytecodeFile,
+    const lama::interpreter::InstructionStream *code
+)
+    : BytecodeInterpreterState(bytecodeFile, code)
+    , stream_(code)
+    , context_{}
+    , entry_(nullptr) {
+    context_.state = this;
+}
+
+void lama::jit::NativeCodeState::compile() {
+    TemplateCompiler compiler{
+        stream_,
+        getGlobalValueAddress(0),
+        reinterpret_cast<const void *>(&NativeCodeState::executeInstructionAt)
+    };
+    compiler.compile();
+
+    memory_ = std::make_unique<ExecutableMemory>(compiler.getCode());
+
+    nativeAddresses_.resize(stream_->size());
+
+    for (instr_index_t i = 0; i < stream_->size(); ++i) {
+        nativeAddresses_[i] = memory_->data() + compiler.getInstructionPosition(i);
+    }
+
+    context_.exitAddress = memory_->data() + compiler.getExitPosition();
+    context_.nativeAddresses = nativeAddresses_.data();
+
+    entry_ = reinterpret_cast<EntryFunction>(memory_->data() + compiler.getEntryPosition());
+}
+
+void lama::jit::NativeCodeState::updateContext() {
+    if (!hasFrames()) {
+        return;
+    }
+
+    context_.locals = getLocalValueAddress(0);
+    context_.args = getArgumentValueAddress(0);
+}
+
+const void* lama::jit::NativeCodeState::executeInstructionAt(NativeContext *context, instr_index_t index) {
+    NativeCodeState *state = static_cast<NativeCodeState *>(context->state);
+
+    state->setIp(index);
+    state->executeInstruction(state->fetchInstruction());
+
+    if (state->isEndReached()) {
+        return context->exitAddress;
+    }
+
+    state->updateContext();
+
+    return context->nativeAddresses[state->getIp()];
+}
+
+void lama::jit::NativeCodeState::run() {
+    if (isEndReached()) {
+        return;
+    }
+
+    compile();
+    updateContext();
+
+    entry_(&context_, nativeAddresses_[getIp()]);
+}
+#endif
+
+bool lama::jit::runNativeCode(const lama::bytecode::BytecodeFile *file, const lama::interpreter::InstructionStream *code) {
+#ifdef LAMA_JIT
+    lama::jit::NativeCodeState state{file, code};
+    state.run();
+
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,74 @@
+#ifndef JIT_TEMPLATE_JIT_HPP
+#define JIT_TEMPLATE_JIT_HPP
+
+#include <memory>
+#include <vector>
+
+#include "../bytecode/source_file.hpp"
+#include "../interpreter/instruction_stream.hpp"
+#include "../interpreter/interpreter.hpp"
+
+#include "executable_memory.hpp"
+
+/*
+ * The template JIT emits x86-64 code and relies on mmap, so it is available on x86-64 Linux only.
+ * It is disabled in debug builds, since native code does not trace the instructions.
+ * Define LAMA_NO_JIT to disable it.
+ */
+#if defined(__x86_64__) && defined(__linux__) && !defined(LAMA_NO_JIT) && !defined(INTERPRETER_DEBUG)
+#define LAMA_JIT
+#endif
+
+namespace lama::jit {
+#ifdef LAMA_JIT
+/*
+ * The part of the execution state shared with native code, its layout is a part of
+ * the native code contract. Frame pointers are updated by every runtime helper call
+ */
+struct NativeContext {
+    lama::runtime::Word *locals;
+    lama::runtime::Word *args;
+    const void *exitAddress;
+    const void * const *nativeAddresses;
+    void *state;
+};
+
+/*
+ * Executes statically verified code translated to native code instruction by instruction
+ * with templates. Simple instructions (constants, variables access, integer binops, jumps)
+ * are inlined, the others are executed by the interpreter handlers called from native code.
+ *
+ * Native code keeps the operand stack in memory, so the __gc_stack_top/__gc_stack_bottom contract
+ * holds whenever the runtime may be called: the end of the operand stack is saved
+ * to __gc_stack_bottom before each helper call and reloaded after it
+ */
+class NativeCodeState : public lama::interpreter::BytecodeInterpreterState<lama::interpreter::VerificationMode::STATIC_VERIFICATION> {
+public:
+    NativeCodeState(
+        const lama::bytecode::BytecodeFile *bytecodeFile,
+        const lama::interpreter::InstructionStream *code
+    );
+
+    void run();
+private:
+    using EntryFunction = void (*)(NativeContext *context, const void *address);
+
+    const lama::interpreter::InstructionStream *stream_;
+    NativeContext context_;
+    std::unique_ptr<ExecutableMemory> memory_;
+    std::vector<const void *> nativeAddresses_;
+    EntryFunction entry_;
+
+    void compile();
+    void updateContext();
+
+    /* Executes the instruction with the given index, returns the native address to continue from */
+    static const void* executeInstructionAt(NativeContext *context, lama::interpreter::instr_index_t index);
+};
+#endif
+
+/* Returns false if native code is not supported on this platform */
+bool runNativeCode(const lama::bytecode::BytecodeFile *file, const lama::interpreter::InstructionStream *code);
+}
+
+#endif
@@ -0,0 +1,206 @@
+#include "x86_64_assembler.hpp"
+
+#include <cstring>
+#include <iterator>
+
+namespace {
+    unsigned getRegisterCode(lama::jit::Register reg) {
+        return static_cast<unsigned>(reg);
+    }
+}
+
+void lama::jit::X86_64Assembler::emitInt32(std::int32_t value) {
+    std::uint8_t bytes[sizeof(value)];
+    std::memcpy(bytes, &value, sizeof(value));
+
+    code_.insert(code_.end(), std::begin(bytes), std::end(bytes));
+}
+
+void lama::jit::X86_64Assembler::emitInt64(std::uint64_t value) {
+    std::uint8_t bytes[sizeof(value)];
+    std::memcpy(bytes, &value, sizeof(value));
+
+    code_.insert(code_.end(), std::begin(bytes), std::end(bytes));
+}
+
+void lama::jit::X86_64Assembler::emitRex(bool wide, unsigned reg, unsigned index, unsigned base) {
+    const std::uint8_t rex = 0x40
+        | (wide ? 0x8 : 0x0)
+        | ((reg >> 3) << 2)
+        | ((index >> 3) << 1)
+        | (base >> 3);
+
+    if (rex != 0x40) {
+        emitByte(rex);
+    }
+}
+
+void lama::jit::X86_64Assembler::emitRegReg(std::uint8_t opcode, Register reg, Register rm) {
+    emitRex(true, getRegisterCode(reg), 0, getRegisterCode(rm));
+    emitByte(opcode);
+    emitByte(0xc0 | (getRegisterCode(reg) & 7) << 3 | (getRegisterCode(rm) & 7));
+}
+
+void lama::jit::X86_64Assembler::emitRegMem(std::uint8_t opcode, Register reg, Register base, std::int32_t disp) {
+    emitRex(true, getRegisterCode(reg), 0, getRegisterCode(base));
+    emitByte(opcode);
+    emitByte(0x80 | (getRegisterCode(reg) & 7) << 3 | (getRegisterCode(base) & 7));
+
+    // rsp and r12 as a base require the SIB byte
+    if ((getRegisterCode(base) & 7) == 4) {
+        emitByte(0x24);
+    }
+
+    emitInt32(disp);
+}
+
+void lama::jit::X86_64Assembler::emitExtImm32(std::uint8_t ext, Register rm, std::int32_t imm) {
+    emitRex(true, 0, 0, getRegisterCode(rm));
+    emitByte(0x81);
+    emitByte(0xc0 | ext << 3 | (getRegisterCode(rm) & 7));
+    emitInt32(imm);
+}
+
+void lama::jit::X86_64Assembler::movImm64(Register dst, std::uint64_t imm) {
+    emitRex(true, 0, 0, getRegisterCode(dst));
+    emitByte(0xb8 | (getRegisterCode(dst) & 7));
+    emitInt64(imm);
+}
+
+void lama::jit::X86_64Assembler::mov(Register dst, Register src) {
+    emitRegReg(0x89, src, dst);
+}
+
+void lama::jit::X86_64Assembler::movLoad(Register dst, Register base, std::int32_t disp) {
+    emitRegMem(0x8b, dst, base, disp);
+}
+
+void lama::jit::X86_64Assembler::movStore(Register base, std::int32_t disp, Register src) {
+    emitRegMem(0x89, src, base, disp);
+}
+
+void lama::jit::X86_64Assembler::add(Register dst, Register src) {
+    emitRegReg(0x01, src, dst);
+}
+
+void lama::jit::X86_64Assembler::sub(Register dst, Register src) {
+    emitRegReg(0x29, src, dst);
+}
+
+void lama::jit::X86_64Assembler::and_(Register dst, Register src) {
+    emitRegReg(0x21, src, dst);
+}
+
+void lama::jit::X86_64Assembler::or_(Register dst, Register src) {
+    emitRegReg(0x09, src, dst);
+}
+
+void lama::jit::X86_64Assembler::imul(Register dst, Register src) {
+    emitRex(true, getRegisterCode(dst), 0, getRegisterCode(src));
+    emitByte(0x0f);
+    emitByte(0xaf);
+    emitByte(0xc0 | (getRegisterCode(dst) & 7) << 3 | (getRegisterCode(src) & 7));
+}
+
+void lama::jit::X86_64Assembler::addImm(Register dst, std::int32_t imm) {
+    emitExtImm32(0, dst, imm);
+}
+
+void lama::jit::X86_64Assembler::subImm(Register dst, std::int32_t imm) {
+    emitExtImm32(5, dst, imm);
+}
+
+void lama::jit::X86_64Assembler::orImm(Register dst, std::int32_t imm) {
+    emitExtImm32(1, dst, imm);
+}
+
+void lama::jit::X86_64Assembler::cmpImm(Register dst, std::int32_t imm) {
+    emitExtImm32(7, dst, imm);
+}
+
+void lama::jit::X86_64Assembler::testImm(Register dst, std::int32_t imm) {
+    emitRex(true, 0, 0, getRegisterCode(dst));
+    emitByte(0xf7);
+    emitByte(0xc0 | (getRegisterCode(dst) & 7));
+    emitInt32(imm);
+}
+
+void lama::jit::X86_64Assembler::sar1(Register dst) {
+    emitRex(true, 0, 0, getRegisterCode(dst));
+    emitByte(0xd1);
+    emitByte(0xc0 | 7 << 3 | (getRegisterCode(dst) & 7));
+}
+
+void lama::jit::X86_64Assembler::cmp(Register lhs, Register rhs) {
+    emitRegReg(0x39, rhs, lhs);
+}
+
+void lama::jit::X86_64Assembler::setcc(Condition cond, Register dst) {
+    emitByte(0x0f);
+    emitByte(0x90 | static_cast<std::uint8_t>(cond));
+    emitByte(0xc0 | (getRegisterCode(dst) & 7));
+}
+
+void lama::jit::X86_64Assembler::andByte(Register dst, Register src) {
+    emitByte(0x20);
+    emitByte(0xc0 | (getRegisterCode(src) & 7) << 3 | (getRegisterCode(dst) & 7));
+}
+
+void lama::jit::X86_64Assembler::movzxByte(Register dst, Register src) {
+    emitByte(0x0f);
+    emitByte(0xb6);
+    emitByte(0xc0 | (getRegisterCode(dst) & 7) << 3 | (getRegisterCode(src) & 7));
+}
+
+void lama::jit::X86_64Assembler::push(Register reg) {
+    emitRex(false, 0, 0, getRegisterCode(reg));
+    emitByte(0x50 | (getRegisterCode(reg) & 7));
+}
+
+void lama::jit::X86_64Assembler::pop(Register reg) {
+    emitRex(false, 0, 0, getRegisterCode(reg));
+    emitByte(0x58 | (getRegisterCode(reg) & 7));
+}
+
+void lama::jit::X86_64Assembler::call(Register target) {
+    emitRex(false, 0, 0, getRegisterCode(target));
+    emitByte(0xff);
+    emitByte(0xc0 | 2 << 3 | (getRegisterCode(target) & 7));
+}
+
+void lama::jit::X86_64Assembler::jmp(Register target) {
+    emitRex(false, 0, 0, getRegisterCode(target));
+    emitByte(0xff);
+    emitByte(0xc0 | 4 << 3 | (getRegisterCode(target) & 7));
+}
+
+void lama::jit::X86_64Assembler::ret() {
+    emitByte(0xc3);
+}
+
+lama::jit::X86_64Assembler::position_t lama::jit::X86_64Assembler::jmpRel32() {
+    emitByte(0xe9);
+
+    const position_t dispPosition = getPosition();
+    emitInt32(0);
+
+    return dispPosition;
+}
+
+lama::jit::X86_64Assembler::position_t lama::jit::X86_64Assembler::jccRel32(Condition cond) {
+    emitByte(0x0f);
+    emitByte(0x80 | static_cast<std::uint8_t>(cond));
+
+    const position_t dispPosition = getPosition();
+    emitInt32(0);
+
+    return dispPosition;
+}
+
+void lama::jit::X86_64Assembler::patchRel32(position_t dispPosition, position_t target) {
+    const std::int32_t disp = static_cast<std::int32_t>(
+        static_cast<std::int64_t>(target) - static_cast<std::int64_t>(dispPosition + sizeof(std::int32_t))
+    );
+
+    std::memcpy(code_.data() + dispPosition, &disp, sizeof(disp));
+}
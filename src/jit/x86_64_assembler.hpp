@@ -0,0 +1,109 @@
+#ifndef JIT_X86_64_ASSEMBLER_HPP
+#define JIT_X86_64_ASSEMBLER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lama::jit {
+enum class Register : unsigned char {
+    RAX = 0,
+    RCX = 1,
+    RDX = 2,
+    RBX = 3,
+    RSP = 4,
+    RBP = 5,
+    RSI = 6,
+    RDI = 7,
+    R8 = 8,
+    R9 = 9,
+    R10 = 10,
+    R11 = 11,
+    R12 = 12,
+    R13 = 13,
+    R14 = 14,
+    R15 = 15,
+};
+
+/* Condition codes as encoded in the low nibble of Jcc and SETcc opcodes */
+enum class Condition : unsigned char {
+    EQUAL = 0x4,
+    NOT_EQUAL = 0x5,
+    LESS = 0xc,
+    GREATER_OR_EQUAL = 0xd,
+    LESS_OR_EQUAL = 0xe,
+    GREATER = 0xf,
+};
+
+/*
+ * A minimal x86-64 assembler emitting just the instructions used by the code templates.
+ * Memory operands are always encoded as [base + disp32]
+ */
+class X86_64Assembler {
+public:
+    using position_t = std::size_t;
+
+    const std::vector<std::uint8_t>& getCode() const {
+        return code_;
+    }
+
+    position_t getPosition() const {
+        return code_.size();
+    }
+
+    void movImm64(Register dst, std::uint64_t imm);
+    void mov(Register dst, Register src);
+    void movLoad(Register dst, Register base, std::int32_t disp);
+    void movStore(Register base, std::int32_t disp, Register src);
+
+    void add(Register dst, Register src);
+    void sub(Register dst, Register src);
+    void and_(Register dst, Register src);
+    void or_(Register dst, Register src);
+    void imul(Register dst, Register src);
+
+    void addImm(Register dst, std::int32_t imm);
+    void subImm(Register dst, std::int32_t imm);
+    void orImm(Register dst, std::int32_t imm);
+    void cmpImm(Register dst, std::int32_t imm);
+    void testImm(Register dst, std::int32_t imm);
+
+    void sar1(Register dst);
+    void cmp(Register lhs, Register rhs);
+
+    /* Only the registers with encodings below 4 are supported, so no REX prefix is needed */
+    void setcc(Condition cond, Register dst);
+    void andByte(Register dst, Register src);
+    void movzxByte(Register dst, Register src);
+
+    void push(Register reg);
+    void pop(Register reg);
+
+    void call(Register target);
+    void jmp(Register target);
+    void ret();
+
+    /* Emit a jump with zero displacement, returns the position of the displacement */
+    position_t jmpRel32();
+    position_t jccRel32(Condition cond);
+
+    /* Sets the displacement at the given position to jump to the target position */
+    void patchRel32(position_t dispPosition, position_t target);
+private:
+    std::vector<std::uint8_t> code_;
+
+    void emitByte(std::uint8_t byte) {
+        code_.push_back(byte);
+    }
+
+    void emitInt32(std::int32_t value);
+    void emitInt64(std::uint64_t value);
+
+    void emitRex(bool wide, unsigned reg, unsigned index, unsigned base);
+    void emitRegReg(std::uint8_t opcode, Register reg, Register rm);
+    void emitRegMem(std::uint8_t opcode, Register reg, Register base, std::int32_t disp);
+    void emitExtImm32(std::uint8_t ext, Register rm, std::int32_t imm);
+};
+}
+
+#endif
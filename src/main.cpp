@@ -1,35 +1,155 @@
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
 
 #include "idiom/idiom_analyzer.hpp"
+#include "idiom/idiom_corpus.hpp"
+#include "idiom/idiom_profile.hpp"
+#include "idiom/idiom_writer.hpp"
 #include "bytecode/source_file.hpp"
 #include "bytecode/source_file_reader.hpp"
 
 #include "interpreter/interpreter.hpp"
 
-extern "C" {
-    int32_t disassemble_instruction(FILE *f, const lama::bytecode::bytefile_t *bf, uint32_t offset);
-}
-
 namespace {
+    constexpr unsigned long MAX_IDIOM_LENGTH = 1024;
+
+    /* A pair of the idiom profile is fused only if it makes up at least this share of all the pairs */
+    constexpr std::uint64_t MIN_SUPERINSTRUCTION_PERCENT = 1;
+
     void printUsage(std::ostream &os) {
-        os << "Usage: ./lama-interpreter [-s | -i] [bytecode-file]\n";
+        os << "Usage: ./lama-interpreter [-s | -j | -l | -i [-n max-idiom-length] [-a]] [-c] [-f text | jsonl | csv] [-p idiom-profile] [-e executed-idioms-file] [bytecode-file]\n"
+           << "       ./lama-interpreter -i [-n max-idiom-length] [-a] [-f text | jsonl | csv] [-p idiom-profile] [bytecode-file | directory]...\n";
     }
 
-    void printInstrSeq(const lama::bytecode::BytecodeFile *file, lama::idiom::idiom_record_t span) {
-        const auto [offset, instrNum] = span;
+    int writeIdiomProfileFile(std::string_view path, const lama::idiom::IdiomProfile &profile) {
+        std::ofstream ofs{path.data()};
+
+        if (!ofs.is_open()) {
+            std::cerr << path << ": cannot open file for writing\n";
+
+            return -5;
+        }
+
+        lama::idiom::writeIdiomProfile(ofs, profile);
+
+        return 0;
+    }
 
-        std::uint32_t ip = offset;
+    /* Pairs without superinstruction handlers are ignored */
+    lama::interpreter::SuperinstructionSet selectSuperinstructions(const lama::idiom::IdiomProfile &profile) {
+        std::uint64_t totalFreq = 0;
 
-        for (std::size_t i = 0; i < instrNum; ++i) {
-            std::cout << '\t';
+        for (const lama::idiom::InstructionPairFrequency &pair : profile) {
+            totalFreq += pair.freq;
+        }
 
-            const std::int32_t curInstrLen = ::disassemble_instruction(stdout, file->getRawBytefile(), ip);
-            ip += curInstrLen;
+        lama::interpreter::SuperinstructionSet superinstructions;
 
-            std::cout << "; ";
+        for (const lama::idiom::InstructionPairFrequency &pair : profile) {
+            // the total fits in 64 bits (see readIdiomProfileFromFile), so the threshold is computed without overflow
+            if (pair.freq >= totalFreq / 100 * MIN_SUPERINSTRUCTION_PERCENT) {
+                superinstructions.enable(pair.first, pair.second);
+            }
         }
+
+        return superinstructions;
+    }
+
+    /* Directories are searched for .bc files recursively, files found in a directory are ordered by their paths */
+    std::optional<std::vector<std::string>> collectCorpusPaths(char **inputsBegin, char **inputsEnd) {
+        std::vector<std::string> paths;
+
+        for (char **input = inputsBegin; input != inputsEnd; ++input) {
+            std::error_code ec;
+
+            if (!std::filesystem::is_directory(*input, ec)) {
+                paths.emplace_back(*input);
+                continue;
+            }
+
+            std::vector<std::string> directoryPaths;
+
+            for (std::filesystem::recursive_directory_iterator it{*input, ec}; !ec && it != std::filesystem::recursive_directory_iterator{}; it.increment(ec)) {
+                if (it->path().extension() == ".bc" && it->is_regular_file(ec)) {
+                    directoryPaths.push_back(it->path().string());
+                }
+            }
+
+            if (ec) {
+                std::cerr << *input << ": cannot read directory\n";
+
+                return std::nullopt;
+            }
+
+            std::sort(directoryPaths.begin(), directoryPaths.end());
+            paths.insert(paths.end(), directoryPaths.begin(), directoryPaths.end());
+        }
+
+        return paths;
+    }
+
+    int analyzeCorpus(
+        char **inputsBegin,
+        char **inputsEnd,
+        std::uint32_t maxIdiomLength,
+        lama::idiom::OperandsGrouping grouping,
+        lama::idiom::IdiomOutputFormat format,
+        std::optional<std::string_view> profileFile
+    ) {
+        // files keep views of their paths
+        const std::optional<std::vector<std::string>> paths = collectCorpusPaths(inputsBegin, inputsEnd);
+
+        if (!paths) {
+            return -4;
+        } else if (paths->empty()) {
+            std::cerr << "No bytecode files found\n";
+            printUsage(std::cerr);
+
+            return -4;
+        }
+
+        std::vector<lama::bytecode::BytecodeFile> files;
+        files.reserve(paths->size());
+
+        for (const std::string &path : *paths) {
+            auto result = lama::bytecode::readBytefileFromFile(path);
+
+            if (result.hasError()) {
+                std::cerr << path << ": " << lama::bytecode::stringifyReadBytefileEror(result.getError()) << '\n';
+
+                return static_cast<int>(result.getError());
+            }
+
+            files.push_back(std::move(result.getResult()));
+        }
+
+        std::vector<const lama::bytecode::BytecodeFile *> filePtrs;
+        filePtrs.reserve(files.size());
+
+        for (const lama::bytecode::BytecodeFile &file : files) {
+            filePtrs.push_back(&file);
+        }
+
+        {
+            lama::idiom::IdiomWriter writer{stdout, format, grouping};
+
+            lama::idiom::processCorpusIdiomsFrequencies(filePtrs, [&writer](const lama::bytecode::BytecodeFile *file, const lama::idiom::idiom_record_t &span, std::uint64_t freq){
+                writer.write(file, span, freq);
+            }, maxIdiomLength, grouping);
+        }
+
+        return profileFile ? writeIdiomProfileFile(*profileFile, lama::idiom::buildCorpusIdiomProfile(filePtrs)) : 0;
     }
 }
 
@@ -39,11 +159,6 @@ int main(int argc, char *argv[]) {
         printUsage(std::cerr);
 
         return -1;
-    } else if (argc > 3) {
-        std::cerr << "Too many arguments\n";
-        printUsage(std::cerr);
-
-        return -2;
     }
 
     enum class Mode {
@@ -53,6 +168,15 @@ int main(int argc, char *argv[]) {
 
     Mode mode = Mode::INTERPRETER_MODE;
     lama::interpreter::VerificationMode verMode = lama::interpreter::VerificationMode::DYNAMIC_VERIFICATION;
+    lama::interpreter::ExecutionEngine engine = lama::interpreter::ExecutionEngine::INTERPRETER;
+    bool useVerificationCache = false;
+    bool lazyVerification = false;
+
+    std::optional<std::string_view> profileFile = std::nullopt;
+    std::uint32_t maxIdiomLength = lama::idiom::DEFAULT_MAX_IDIOM_LENGTH;
+    lama::idiom::OperandsGrouping grouping = lama::idiom::OperandsGrouping::EXACT;
+    lama::idiom::IdiomOutputFormat format = lama::idiom::IdiomOutputFormat::TEXT;
+    std::optional<std::string_view> executedIdiomsFile = std::nullopt;
 
     std::size_t fileArgIndex = 1;
 
@@ -64,6 +188,46 @@ int main(int argc, char *argv[]) {
                 mode = Mode::IDIOM_ANALYSIS_MODE;
             } else if (arg[1] == 's' && arg[2] == '\0') {
                 verMode = lama::interpreter::VerificationMode::STATIC_VERIFICATION;
+            } else if (arg[1] == 'j' && arg[2] == '\0') {
+                // native code requires statically verified bytecode
+                verMode = lama::interpreter::VerificationMode::STATIC_VERIFICATION;
+                engine = lama::interpreter::ExecutionEngine::NATIVE_CODE;
+            } else if (arg[1] == 'l' && arg[2] == '\0') {
+                verMode = lama::interpreter::VerificationMode::STATIC_VERIFICATION;
+                lazyVerification = true;
+            } else if (arg[1] == 'a' && arg[2] == '\0') {
+                grouping = lama::idiom::OperandsGrouping::CLASSES;
+            } else if (arg[1] == 'c' && arg[2] == '\0') {
+                useVerificationCache = true;
+            } else if (arg[1] == 'p' && arg[2] == '\0' && fileArgIndex + 1 < argc) {
+                profileFile = argv[++fileArgIndex];
+            } else if (arg[1] == 'e' && arg[2] == '\0' && fileArgIndex + 1 < argc) {
+                executedIdiomsFile = argv[++fileArgIndex];
+            } else if (arg[1] == 'f' && arg[2] == '\0' && fileArgIndex + 1 < argc) {
+                const char * const value = argv[++fileArgIndex];
+                const std::optional<lama::idiom::IdiomOutputFormat> parsedFormat = lama::idiom::parseIdiomOutputFormat(value);
+
+                if (!parsedFormat) {
+                    std::cerr << "Wrong output format: " << value << '\n';
+                    printUsage(std::cerr);
+
+                    return -3;
+                }
+
+                format = *parsedFormat;
+            } else if (arg[1] == 'n' && arg[2] == '\0' && fileArgIndex + 1 < argc) {
+                const char * const value = argv[++fileArgIndex];
+                char *valueEnd = nullptr;
+                const unsigned long length = std::strtoul(value, &valueEnd, 10);
+
+                if (*value < '0' || *value > '9' || *valueEnd != '\0' || length == 0 || length > MAX_IDIOM_LENGTH) {
+                    std::cerr << "Wrong idiom length: " << value << '\n';
+                    printUsage(std::cerr);
+
+                    return -3;
+                }
+
+                maxIdiomLength = length;
             } else {
                 std::cerr << "Unknown option: " << arg << '\n';
                 printUsage(std::cerr);
@@ -84,6 +248,17 @@ int main(int argc, char *argv[]) {
         return -4;
     }
 
+    std::error_code ec;
+
+    if (mode == Mode::IDIOM_ANALYSIS_MODE && (fileArgIndex + 1 < argc || std::filesystem::is_directory(argv[fileArgIndex], ec))) {
+        return analyzeCorpus(argv + fileArgIndex, argv + argc, maxIdiomLength, grouping, format, profileFile);
+    } else if (fileArgIndex + 1 < argc) {
+        std::cerr << "Too many arguments\n";
+        printUsage(std::cerr);
+
+        return -2;
+    }
+
     std::string_view inputFile = argv[fileArgIndex];
     auto result = lama::bytecode::readBytefileFromFile(inputFile);
 
@@ -97,16 +272,63 @@ int main(int argc, char *argv[]) {
     lama::bytecode::BytecodeFile& bcf = result.getResult();
 
     switch (mode) {
-        case Mode::INTERPRETER_MODE:
-            lama::interpreter::interpretBytecodeFile(&bcf, verMode);
+        case Mode::INTERPRETER_MODE: {
+            lama::interpreter::SuperinstructionSet superinstructions;
+
+            if (profileFile) {
+                auto profileResult = lama::idiom::readIdiomProfileFromFile(*profileFile);
+
+                if (profileResult.hasError()) {
+                    std::cerr << *profileFile << ": " << lama::idiom::stringifyReadIdiomProfileError(profileResult.getError()) << '\n';
+
+                    return -5;
+                }
+
+                superinstructions = selectSuperinstructions(profileResult.getResult());
+            }
+
+            if (!executedIdiomsFile) {
+                lama::interpreter::interpretBytecodeFile(&bcf, verMode, superinstructions, engine, useVerificationCache, lazyVerification);
+                break;
+            }
+
+            std::FILE *executedIdiomsOutput = std::fopen(executedIdiomsFile->data(), "w");
+
+            if (executedIdiomsOutput == nullptr) {
+                std::cerr << *executedIdiomsFile << ": cannot open file for writing\n";
+
+                return -5;
+            }
+
+            lama::interpreter::ExecutionProfile executionProfile{bcf.getCodeSize()};
+            lama::interpreter::interpretBytecodeFile(&bcf, verMode, superinstructions, engine, useVerificationCache, lazyVerification, &executionProfile);
+
+            {
+                lama::idiom::IdiomWriter writer{executedIdiomsOutput, format, lama::idiom::OperandsGrouping::EXACT};
+
+                lama::idiom::processExecutedIdiomsFrequencies(&bcf, executionProfile, [&bcf, &writer](const lama::idiom::idiom_record_t &span, std::uint64_t freq){
+                    writer.write(&bcf, span, freq);
+                });
+            }
+
+            std::fclose(executedIdiomsOutput);
             break;
-        case Mode::IDIOM_ANALYSIS_MODE:
-            lama::idiom::processIdiomsFrequencies(&bcf, [&bcf](const lama::idiom::idiom_record_t &span, std::uint32_t freq){
-                std::cout << freq;
-                printInstrSeq(&bcf, span);
-                std::cout << '\n';
-            });
+        }
+        case Mode::IDIOM_ANALYSIS_MODE: {
+            {
+                lama::idiom::IdiomWriter writer{stdout, format, grouping};
+
+                lama::idiom::processIdiomsFrequencies(&bcf, [&bcf, &writer](const lama::idiom::idiom_record_t &span, std::uint64_t freq){
+                    writer.write(&bcf, span, freq);
+                }, maxIdiomLength, grouping);
+            }
+
+            if (profileFile) {
+                return writeIdiomProfileFile(*profileFile, lama::idiom::buildIdiomProfile(&bcf));
+            }
+
             break;
+        }
     }
 
     return 0;